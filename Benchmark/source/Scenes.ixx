@@ -0,0 +1,253 @@
+module;
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+export module Scenes;
+
+import Rev.Element;
+import Rev.Element.Style;
+
+import Rev.Element.Box;
+import Rev.Element.TextBox;
+import Rev.Element.Chart;
+
+export namespace Benchmark {
+
+    using namespace Rev;
+    using namespace Rev::Element;
+
+    // A synthetic tree filling the window, which changes a little every frame
+    struct Scene : public Box {
+
+        // Create
+        Scene(Element* parent, std::string name) : Box(parent, name) {
+            this->style->size = { .width = 100_pct, .height = 100_pct };
+            this->style->background.color = rgba(25, 25, 25, 1.0);
+        }
+
+        // Change something, as an application would between frames
+        virtual void step(size_t frame) {}
+    };
+
+    // Boxes nested inside one another (every few clipping their contents), with text at the bottom
+    struct DeepNest : public Scene {
+
+        TextBox* leaf = nullptr;
+
+        // Create
+        DeepNest(Element* parent, size_t depth = 256) : Scene(parent, "DeepNest") {
+
+            Box* box = this;
+
+            for (size_t i = 0; i < depth; i++) {
+
+                box = new Box(box);
+                box->style = {
+                    .overflow = (i % 8 == 7) ? Overflow::Hide : Overflow::Show,
+                    .size = { .width = Grow(), .height = Grow() },
+                    .padding = { 1_px, 1_px, 1_px, 1_px },
+                    .border = { .radius = 2_px },
+                    .background = { .color = rgba(255, 255, 255, 0.02) }
+                };
+            }
+
+            leaf = new TextBox(box, "Leaf");
+        }
+
+        void step(size_t frame) override {
+            leaf->setContent(float(frame), 0);
+        }
+    };
+
+    // Rows of growing boxes, one of which changes size (so its row must lay out again)
+    struct WideRows : public Scene {
+
+        std::vector<Box*> boxes;
+
+        // Create
+        WideRows(Element* parent, size_t rows = 100, size_t columns = 100) : Scene(parent, "WideRows") {
+
+            this->style->alignment = { Axis::Vertical, Align::Start, Align::Start };
+
+            for (size_t r = 0; r < rows; r++) {
+
+                Box* row = new Box(this);
+                row->style = {
+                    .size = { .width = Grow(), .height = Grow() },
+                    .alignment = { Axis::Horizontal, Align::Start, Align::Start }
+                };
+
+                for (size_t c = 0; c < columns; c++) {
+
+                    Box* box = new Box(row);
+                    box->style = {
+                        .size = { .width = Grow(), .height = Grow() },
+                        .margin = { 1_px, 1_px, 1_px, 1_px },
+                        .background = { .color = rgba(255, 255, 255, 0.1) }
+                    };
+
+                    boxes.push_back(box);
+                }
+            }
+        }
+
+        void step(size_t frame) override {
+
+            Box* box = boxes[boxes.size() / 2];
+
+            box->style->size.width = Px(float(4 + frame % 16));
+            box->refresh(*shared->event);
+        }
+    };
+
+    // Many small text boxes, one of which changes text
+    struct TextBoxes : public Scene {
+
+        std::vector<TextBox*> texts;
+
+        // Create
+        TextBoxes(Element* parent, size_t rows = 100, size_t columns = 100) : Scene(parent, "TextBoxes") {
+
+            this->style->alignment = { Axis::Vertical, Align::Start, Align::Start };
+
+            for (size_t r = 0; r < rows; r++) {
+
+                Box* row = new Box(this);
+                row->style = {
+                    .size = { .width = Grow(), .height = Grow() },
+                    .alignment = { Axis::Horizontal, Align::Start, Align::Start }
+                };
+
+                for (size_t c = 0; c < columns; c++) {
+
+                    TextBox* text = new TextBox(row, std::to_string(r * columns + c));
+                    text->style->text.size = 8_px;
+
+                    texts.push_back(text);
+                }
+            }
+        }
+
+        void step(size_t frame) override {
+            texts[(frame * 7919) % texts.size()]->setContent(float(frame), 0);
+        }
+    };
+
+    // A log pane holding thousands of lines, a line appended every frame
+    struct LogPane : public Scene {
+
+        TextBox* log = nullptr;
+        size_t written = 0;
+
+        // Create
+        LogPane(Element* parent, size_t lines = 5000) : Scene(parent, "LogPane") {
+
+            this->style->overflow = Overflow::Hide;
+
+            log = new TextBox(this, "");
+            log->style->text.size = 10_px;
+
+            std::string backlog;
+            for (size_t i = 0; i < lines; i++) { backlog += this->line(); }
+
+            log->setContent(backlog);
+        }
+
+        std::string line() {
+            written += 1;
+            return "[" + std::to_string(written) + "] frame submitted, " + std::to_string((written * 7919) % 1000) + " glyphs\n";
+        }
+
+        void step(size_t frame) override {
+            log->addContent(this->line());
+        }
+    };
+
+    // Boxes fading between colors (paint-only animations, retargeted before they finish)
+    struct Fades : public Scene {
+
+        std::vector<Box*> boxes;
+
+        // Create
+        Fades(Element* parent, size_t rows = 50, size_t columns = 50) : Scene(parent, "Fades") {
+
+            this->style->alignment = { Axis::Vertical, Align::Start, Align::Start };
+
+            for (size_t r = 0; r < rows; r++) {
+
+                Box* row = new Box(this);
+                row->style = {
+                    .size = { .width = Grow(), .height = Grow() },
+                    .alignment = { Axis::Horizontal, Align::Start, Align::Start }
+                };
+
+                for (size_t c = 0; c < columns; c++) {
+
+                    Box* box = new Box(row);
+                    box->style = {
+                        .size = { .width = Grow(), .height = Grow() },
+                        .margin = { 1_px, 1_px, 1_px, 1_px },
+                        .background = { .color = rgba(255, 255, 255, 0.1), .transition = 100 }
+                    };
+
+                    boxes.push_back(box);
+                }
+            }
+        }
+
+        // A tenth of the boxes head for a new color each frame
+        void step(size_t frame) override {
+
+            for (size_t i = frame % 10; i < boxes.size(); i += 10) {
+
+                float shade = float((i + frame) % 7) * 40.0f;
+
+                boxes[i]->style->background.color = rgba(shade, 128, 255 - shade, 0.5);
+                boxes[i]->refresh(*shared->event);
+            }
+        }
+    };
+
+    // A chart holding a long series, streaming in more and scrolling to follow
+    struct LargeChart : public Scene {
+
+        Chart* chart = nullptr;
+        size_t streamed = 0;
+        size_t perFrame = 0;
+
+        // Create
+        LargeChart(Element* parent, size_t samples = 1 << 20, size_t perFrame = 1024) : Scene(parent, "LargeChart") {
+
+            this->perFrame = perFrame;
+
+            chart = new Chart(this);
+            chart->style = {
+                .size = { .width = Grow(), .height = Grow() }
+            };
+
+            chart->series.setCapacity(samples);
+            this->stream(samples);
+        }
+
+        // Append noisy samples
+        void stream(size_t num) {
+
+            for (size_t i = 0; i < num; i++, streamed++) {
+                float t = float(streamed) / float(1 << 16);
+                float noise = float((streamed * 2654435761u) % 1000) / 1000.0f - 0.5f;
+                chart->append({ t, 0.5f + 0.3f * std::sin(20.0f * t) + 0.1f * noise });
+            }
+
+            // Show everything held
+            chart->view.l = chart->series.at(chart->series.first()).x;
+            chart->view.r = chart->series.at(chart->series.total - 1).x;
+        }
+
+        void step(size_t frame) override {
+            this->stream(perFrame);
+        }
+    };
+};
@@ -0,0 +1,297 @@
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+
+import Rev.Application;
+import Rev.Element.Window;
+import Rev.Graphics.Canvas;
+import Rev.Primitive.Lines;
+
+import Scenes;
+
+using namespace Rev;
+using namespace Benchmark;
+
+// Runs synthetic scenes on the headless canvas, reporting how long each phase of a frame
+// takes (percentiles over many frames), for full and incremental recomputing.
+//
+//   RevBenchmark [--frames N] [--scene name] [--width W] [--height H]
+//                [--golden dir] [--compare dir] [--tolerance T] [--lines gpu|cpu]
+//                [--submit inline|thread]
+//
+// With --golden the last frame of each scene is rasterized and written to dir/<scene>.ppm,
+// with --compare it is checked against those images instead (exiting with 1 if any differ).
+// Lines are expanded where --lines says (both ways give the same geometry, see the tests).
+// Frames are submitted where --submit says, as they end or from a render thread (pipelined).
+
+struct Options {
+    size_t frames = 200;
+    std::string scene = "all";
+    int width = 1280, height = 720;
+    std::string golden, compare;
+    int tolerance = 2;
+    std::string lines = "gpu";
+    std::string submit = "inline";
+};
+
+Scene* createScene(const std::string& name, Element::Element* parent) {
+    if (name == "DeepNest") { return new DeepNest(parent); }
+    if (name == "WideRows") { return new WideRows(parent); }
+    if (name == "TextBoxes") { return new TextBoxes(parent); }
+    if (name == "LargeChart") { return new LargeChart(parent); }
+    if (name == "Fades") { return new Fades(parent); }
+    if (name == "LogPane") { return new LogPane(parent); }
+    return nullptr;
+}
+
+// Reporting
+//--------------------------------------------------
+
+struct Samples {
+
+    std::vector<double> values;
+
+    double percentile(double p) {
+
+        if (values.empty()) { return 0; }
+
+        std::vector<double> sorted = values;
+        std::sort(sorted.begin(), sorted.end());
+
+        size_t idx = size_t(std::ceil(p / 100.0 * double(sorted.size()))) - 1;
+        return sorted[std::min(idx, sorted.size() - 1)];
+    }
+
+    double mean() {
+
+        double sum = 0;
+        for (double value : values) { sum += value; }
+
+        return values.empty() ? 0 : sum / double(values.size());
+    }
+};
+
+void report(const char* phase, Samples& samples) {
+    std::printf("    %-10s %9.3f %9.3f %9.3f %9.3f\n", phase,
+        samples.percentile(50), samples.percentile(90), samples.percentile(99), samples.percentile(100));
+}
+
+// Golden images
+//--------------------------------------------------
+
+void writeImage(const std::string& path, size_t width, size_t height, std::vector<uint8_t>& rgba) {
+
+    std::ofstream file(path, std::ios::binary);
+    file << "P6\n" << width << " " << height << "\n255\n";
+
+    for (size_t i = 0; i < width * height; i++) {
+        file.write(reinterpret_cast<char*>(&rgba[4 * i]), 3);
+    }
+}
+
+bool readImage(const std::string& path, size_t& width, size_t& height, std::vector<uint8_t>& rgb) {
+
+    std::ifstream file(path, std::ios::binary);
+    std::string magic; int max = 0;
+
+    if (!(file >> magic >> width >> height >> max) || magic != "P6" || max != 255) { return false; }
+    file.get();
+
+    rgb.resize(width * height * 3);
+    return bool(file.read(reinterpret_cast<char*>(rgb.data()), rgb.size()));
+}
+
+// Largest difference of any channel (or -1 if the images can't be compared)
+int compareImage(const std::string& path, size_t width, size_t height, std::vector<uint8_t>& rgba) {
+
+    size_t w = 0, h = 0;
+    std::vector<uint8_t> rgb;
+
+    if (!readImage(path, w, h, rgb) || w != width || h != height) { return -1; }
+
+    int largest = 0;
+
+    for (size_t i = 0; i < width * height; i++) {
+        for (size_t c = 0; c < 3; c++) {
+            largest = std::max(largest, std::abs(int(rgba[4 * i + c]) - int(rgb[3 * i + c])));
+        }
+    }
+
+    return largest;
+}
+
+// Running
+//--------------------------------------------------
+
+// Run a scene for some frames, returns false if its image didn't match
+bool run(const std::string& name, Options& options) {
+
+    Application* application = new Application();
+
+    Window::Details details;
+    details.width = options.width;
+    details.height = options.height;
+    details.pipelined = options.submit == "thread";
+
+    Window* window = new Window(application->windows, details);
+    Scene* scene = createScene(name, window);
+
+    Graphics::Canvas& canvas = *window->shared->canvas;
+    canvas.flags.record = false;
+
+    std::printf("%s\n", name.c_str());
+
+    // First frame lays everything out
+    application->run();
+
+    for (bool incremental : { false, true }) {
+
+        window->details.incremental = incremental;
+
+        Samples style, layout, compute, submit, total;
+        Samples drawCalls, stateBinds, uploaded, recomputed, laidOut, animated;
+
+        for (size_t frame = 0; frame < options.frames; frame++) {
+
+            scene->step(frame);
+            window->window->paint();
+
+            Window::FrameStats& stats = window->stats;
+
+            style.values.push_back(stats.styleMs);
+            layout.values.push_back(stats.layoutMs);
+            compute.values.push_back(stats.computeMs);
+            submit.values.push_back(stats.submitMs);
+            total.values.push_back(stats.styleMs + stats.layoutMs + stats.computeMs + stats.submitMs);
+
+            drawCalls.values.push_back(double(stats.drawCalls));
+            stateBinds.values.push_back(double(stats.stateBinds));
+            uploaded.values.push_back(double(canvas.context->bytes) / 1024.0);
+            recomputed.values.push_back(double(stats.recomputed));
+            laidOut.values.push_back(double(stats.laidOut));
+            animated.values.push_back(double(stats.animated));
+        }
+
+        std::printf("  %s (%zu frames, %zu elements)\n", incremental ? "incremental" : "full", options.frames, window->topDown.size());
+        std::printf("    %-10s %9s %9s %9s %9s\n", "ms", "p50", "p90", "p99", "max");
+
+        report("style", style);
+        report("layout", layout);
+        report("compute", compute);
+        report("submit", submit);
+        report("total", total);
+
+        std::printf("    draw calls %.1f, state binds %.1f, uploaded %.1f KiB (mean per frame)\n",
+            drawCalls.mean(), stateBinds.mean(), uploaded.mean());
+        std::printf("    recomputed %.1f, laid out %.1f, animated %.1f (mean per frame)\n",
+            recomputed.mean(), laidOut.mean(), animated.mean());
+    }
+
+    // Moving the cursor about (hit testing and dispatch)
+    Samples input;
+
+    for (size_t i = 0; i < options.frames; i++) {
+
+        float x = float((i * 7919) % size_t(options.width));
+        float y = float((i * 104729) % size_t(options.height));
+
+        auto start = std::chrono::steady_clock::now();
+        window->onCursorPos(x, y);
+        input.values.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::printf("  input (%zu cursor moves)\n", options.frames);
+    report("move", input);
+
+    bool matched = true;
+
+    // Draw one more frame into memory for the golden image
+    if (!options.golden.empty() || !options.compare.empty()) {
+
+        canvas.flags.rasterize = true;
+        window->window->paint();
+        canvas.flags.rasterize = false;
+        canvas.finish();
+
+        std::vector<uint8_t> rgba = canvas.frameBuffer->rgba8();
+        size_t width = canvas.frameBuffer->params.width;
+        size_t height = canvas.frameBuffer->params.height;
+
+        if (!options.golden.empty()) {
+            writeImage(options.golden + "/" + name + ".ppm", width, height, rgba);
+        }
+
+        if (!options.compare.empty()) {
+
+            int difference = compareImage(options.compare + "/" + name + ".ppm", width, height, rgba);
+            matched = difference >= 0 && difference <= options.tolerance;
+
+            std::printf("  image %s (difference %d)\n", matched ? "matches" : "differs", difference);
+        }
+    }
+
+    delete application;
+
+    return matched;
+}
+
+int main(int argc, char** argv) {
+
+    Options options;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+
+        const char* arg = argv[i];
+        const char* value = argv[i + 1];
+
+        if (!std::strcmp(arg, "--frames")) { options.frames = std::strtoul(value, nullptr, 10); }
+        else if (!std::strcmp(arg, "--scene")) { options.scene = value; }
+        else if (!std::strcmp(arg, "--width")) { options.width = std::atoi(value); }
+        else if (!std::strcmp(arg, "--height")) { options.height = std::atoi(value); }
+        else if (!std::strcmp(arg, "--golden")) { options.golden = value; }
+        else if (!std::strcmp(arg, "--compare")) { options.compare = value; }
+        else if (!std::strcmp(arg, "--tolerance")) { options.tolerance = std::atoi(value); }
+        else if (!std::strcmp(arg, "--lines")) { options.lines = value; }
+        else if (!std::strcmp(arg, "--submit")) { options.submit = value; }
+        else { std::fprintf(stderr, "Unknown option %s\n", arg); return 2; }
+    }
+
+    std::vector<std::string> scenes = { "DeepNest", "WideRows", "TextBoxes", "LargeChart", "Fades", "LogPane" };
+
+    if (options.scene != "all") {
+
+        if (std::find(scenes.begin(), scenes.end(), options.scene) == scenes.end()) {
+            std::fprintf(stderr, "Unknown scene %s\n", options.scene.c_str());
+            return 2;
+        }
+
+        scenes = { options.scene };
+    }
+
+    if (options.lines != "gpu" && options.lines != "cpu") {
+        std::fprintf(stderr, "Unknown lines mode %s\n", options.lines.c_str());
+        return 2;
+    }
+
+    if (options.submit != "inline" && options.submit != "thread") {
+        std::fprintf(stderr, "Unknown submit mode %s\n", options.submit.c_str());
+        return 2;
+    }
+
+    Primitive::Lines::defaultMode = (options.lines == "cpu") ? Primitive::Lines::Cpu : Primitive::Lines::Gpu;
+
+    bool matched = true;
+
+    for (const std::string& name : scenes) {
+        matched = run(name, options) && matched;
+    }
+
+    return matched ? 0 : 1;
+}
@@ -54,7 +54,7 @@ export namespace HelloWorld {
                 size_t num = 1000;
                 for (size_t i = 0; i < num; i++) {
                     float t = float(i) / float(num);
-                    chart->points.push_back({ t, 0.5f + 0.5f * sin(10.0f * 3.14159f * t) });
+                    chart->series.append({ t, 0.5f + 0.5f * sin(10.0f * 3.14159f * t) });
                 }
 
                 Slider* slider = new Slider(greyBox);
@@ -9,14 +9,6 @@ struct Transform
     float4x4 uProjection;
 };
 
-// Stroke color + parameters (matches std140 binding = 1)
-struct Data
-{
-    float4 color;        // r,g,b,a
-    float strokeWidth;
-    float miterLimit;
-};
-
 // --- Vertex Input / Output ---
 
 struct VertexIn
@@ -34,16 +26,14 @@ struct VertexOut
 // --- Vertex Shader ---
 
 vertex VertexOut vertex_main(VertexIn in [[stage_in]],
-                             constant Transform& transform [[buffer(10)]],
-                             constant Data& data [[buffer(11)]])
+                             constant Transform& transform [[buffer(10)]])
 {
     VertexOut out;
 
     // Apply projection
     out.position = transform.uProjection * float4(in.aPos, 0.0, 1.0);
 
-    // Proper override: if vertex color is "empty" (alpha == 0), use uniform color
-    out.vColor = (in.aColor.a != 0.0) ? in.aColor : data.color;
+    out.vColor = in.aColor;
 
     return out;
 }
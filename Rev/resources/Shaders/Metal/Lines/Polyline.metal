@@ -0,0 +1,118 @@
+#include <metal_stdlib>
+using namespace metal;
+
+// --- Uniform Buffers ---
+
+// Projection matrix (matches std140 binding = 0)
+struct Transform
+{
+    float4x4 uProjection;
+};
+
+// --- Vertex Input / Output ---
+
+// A point of a polyline stream (separators have negative alpha)
+struct Point
+{
+    float x, y, width;
+    float r, g, b, a;
+};
+
+struct VertexOut
+{
+    float4 position [[position]];
+    float4 vColor;
+};
+
+// --- Vertex Shader ---
+
+// One instance per window of the stream (the points before, at either end of, and after
+// a segment), read straight from the buffer. Follows expandSegment() (TriangulatePolyline.hpp),
+// as Polyline.vert does (and its port in the tests).
+vertex VertexOut vertex_main(const device Point* points [[buffer(0)]],
+                             uint vid [[vertex_id]],
+                             uint iid [[instance_id]],
+                             constant Transform& transform [[buffer(10)]])
+{
+    VertexOut out;
+
+    Point P = points[iid], S = points[iid + 1], E = points[iid + 2], N = points[iid + 3];
+
+    // Not a segment, nothing to draw
+    if (S.a < 0.0 || E.a < 0.0) {
+        out.position = float4(0.0, 0.0, 0.0, 1.0);
+        out.vColor = float4(0.0);
+        return out;
+    }
+
+    float halfT = S.width * 0.5;
+
+    float2 A = float2(P.x, P.y), B = float2(S.x, S.y), C = float2(E.x, E.y), D = float2(N.x, N.y);
+
+    // Direction and (half thickness) normal
+    float2 u = (C - B) / length(C - B);
+    float2 h = float2(-u.y, u.x) * halfT;
+
+    float2 a = B + h, b = B - h, c = C - h, d = C + h;
+
+    // Inside of the join with the previous segment
+    if (P.a >= 0.0) {
+
+        float2 pu = (B - A) / length(B - A);
+        float2 ph = float2(-pu.y, pu.x) * halfT;
+
+        float cross = pu.x * u.y - pu.y * u.x;
+        float side = cross < 0.0 ? -1.0 : 1.0;
+
+        float2 i1 = A + side * ph;
+        float2 i2 = B + side * h;
+
+        float t = ((i2.x - i1.x) * u.y - (i2.y - i1.y) * u.x) / cross;
+        float2 join = fabs(cross) > 1e-3 ? i1 + pu * t : i2;
+
+        if (cross < 0.0) { b = join; }
+        else { a = join; }
+    }
+
+    // Join with the next segment (the triangle is empty without one)
+    float2 o1 = C, o2 = C, join = C;
+
+    if (N.a >= 0.0) {
+
+        float2 nu = (D - C) / length(D - C);
+        float2 nh = float2(-nu.y, nu.x) * halfT;
+
+        float cross = u.x * nu.y - u.y * nu.x;
+        float side = cross < 0.0 ? -1.0 : 1.0;
+
+        float2 i1 = B + side * h;
+        float2 i2 = C + side * nh;
+
+        float t = ((i2.x - i1.x) * nu.y - (i2.y - i1.y) * nu.x) / cross;
+        join = fabs(cross) > 1e-3 ? i1 + u * t : i2;
+
+        if (cross < 0.0) { c = join; }
+        else { d = join; }
+
+        o1 = C - side * h;
+        o2 = C - side * nh;
+    }
+
+    // Quad, then join triangle
+    const float2 corners[9] = { a, b, c, a, c, d, o1, o2, join };
+
+    // Start takes the color of B, the rest that of C
+    bool start = (vid == 0 || vid == 1 || vid == 3);
+
+    out.position = transform.uProjection * float4(corners[vid], 0.0, 1.0);
+    out.vColor = start ? float4(S.r, S.g, S.b, S.a) : float4(E.r, E.g, E.b, E.a);
+
+    return out;
+}
+
+// --- Fragment Shader ---
+
+fragment float4 fragment_main(VertexOut in [[stage_in]])
+{
+    return in.vColor;
+}
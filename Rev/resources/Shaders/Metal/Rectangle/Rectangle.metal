@@ -5,22 +5,25 @@ struct Transform {
     float4x4 uProjection;
 };
 
-struct Data {
-    float x, y, w, h;       // Rect
-    float r, g, b, a;       // Color
-    float tl, tr, bl, br;   // Corner radii
+// Per-instance data
+struct VertexIn {
+    float4 rect    [[attribute(0)]];    // x, y, w, h
+    float4 color   [[attribute(1)]];    // r, g, b, a
+    float4 corners [[attribute(2)]];    // Corner radii (tl, tr, bl, br)
 };
 
 struct VertexOut {
     float4 position [[position]];
     float4 color;
     float2 localPos;        // position in local rect space
+    float2 size [[flat]];
+    float4 corners [[flat]];
 };
 
 vertex VertexOut vertex_main(
+    VertexIn in [[stage_in]],
     uint vid [[vertex_id]],
-    constant Transform& transform [[buffer(10)]],
-    constant Data& data [[buffer(11)]]
+    constant Transform& transform [[buffer(10)]]
 ) {
     const float2 corners[4] = {
         float2(0.0, 0.0), // top-left
@@ -31,16 +34,18 @@ vertex VertexOut vertex_main(
     const ushort indices[6] = { 0, 1, 2, 0, 2, 3 };
 
     float2 cornerOffset = corners[ indices[vid] ];
-    float2 pos = float2(data.x, data.y) + cornerOffset * float2(data.w, data.h);
+    float2 pos = in.rect.xy + cornerOffset * in.rect.zw;
 
     VertexOut out;
     out.position = transform.uProjection * float4(pos, 0.0, 1.0);
 
     // Local coords relative to rect center
-    float2 rectCenter = float2(data.x + data.w * 0.5, data.y + data.h * 0.5);
+    float2 rectCenter = in.rect.xy + in.rect.zw * 0.5;
     out.localPos = pos - rectCenter;
 
-    out.color = float4(data.r, data.g, data.b, data.a);
+    out.color = in.color;
+    out.size = in.rect.zw;
+    out.corners = in.corners;
     return out;
 }
 
@@ -50,10 +55,9 @@ inline float roundedBoxSDF(float2 p, float2 halfSize, float radius) {
     return length(max(q, float2(0.0))) - radius;
 }
 
-fragment float4 fragment_main(VertexOut in [[stage_in]],
-                              constant Data& data [[buffer(11)]])
+fragment float4 fragment_main(VertexOut in [[stage_in]])
 {
-    float2 halfSize = float2(data.w, data.h) * 0.5;
+    float2 halfSize = in.size * 0.5;
 
     // Branchless corner selection
     float isLeft   = 1.0 - step(0.0, in.localPos.x);
@@ -67,10 +71,10 @@ fragment float4 fragment_main(VertexOut in [[stage_in]],
     float w_br = isRight * isBottom;
 
     float cornerRadius = 
-          w_tl * data.tl +
-          w_tr * data.tr +
-          w_bl * data.bl +
-          w_br * data.br;
+          w_tl * in.corners.x +
+          w_tr * in.corners.y +
+          w_bl * in.corners.z +
+          w_br * in.corners.w;
 
     cornerRadius = clamp(cornerRadius, 0.0, min(halfSize.x, halfSize.y));
 
@@ -80,5 +84,5 @@ fragment float4 fragment_main(VertexOut in [[stage_in]],
     float smoothing = 0.5 * fwidth(dist);
     float alpha = 1.0 - smoothstep(-smoothing, smoothing, dist);
 
-    return float4(data.r, data.g, data.b, data.a * alpha);
+    return float4(in.color.rgb, in.color.a * alpha);
 }
@@ -10,33 +10,17 @@ struct Transform {
     float4x4 uProjection;
 };
 
-// GLSL: layout(std140, binding = 1) uniform Data { vec4 color; vec2 pos; };
-struct Data {
-    float4 color;
-    float2 pos;
-    float2 _padding; // std140 rules: pad to 16-byte boundary
-};
-
-// GLSL: struct CharVertex { vec2 pos; vec2 uv; };
-struct CharVertex {
-    float2 pos;
-    float2 uv;
-};
-
-// GLSL: layout(std140, binding = 2) uniform GlyphData { CharVertex glyphs[128 * 6]; };
-struct GlyphData {
-    CharVertex glyphs[128 * 6];
-};
-
 // Vertex input
 struct VertexIn {
-    float4 iPosition [[attribute(0)]]; // xy = pos, z = glyph index, w = unused
+    float4 iRect  [[attribute(0)]]; // xy = glyph position, zw = glyph size
+    float4 iTex   [[attribute(1)]]; // xy = atlas position, zw = atlas size (pixels)
+    float4 iColor [[attribute(2)]];
 };
 
 // Vertex output
 struct VertexOut {
     float4 position [[position]];
-    float2 fragUV;
+    float2 fragTex;
     float4 color;
 };
 
@@ -46,22 +30,23 @@ struct VertexOut {
 vertex VertexOut vertex_main(
     VertexIn in [[stage_in]],
     constant Transform& transform [[buffer(10)]],
-    constant Data& data [[buffer(11)]],
-    constant GlyphData& glyphData [[buffer(12)]],
     uint vid [[vertex_id]]
 ) {
     VertexOut out;
 
-    int glyphIndex = int(in.iPosition.z);
-    int corner     = int(vid % 6);
-    int index      = glyphIndex * 6 + corner;
+    // Two triangles per glyph
+    const float2 corners[6] = {
+        float2(0.0, 0.0), float2(1.0, 0.0), float2(1.0, 1.0),
+        float2(0.0, 0.0), float2(1.0, 1.0), float2(0.0, 1.0)
+    };
 
-    CharVertex v = glyphData.glyphs[index];
+    float2 corner = corners[vid % 6];
 
-    out.fragUV = v.uv;
-    out.color = data.color;
+    // Atlas coords stay in pixels, so the atlas can grow without touching instances
+    out.fragTex = in.iTex.xy + corner * in.iTex.zw;
+    out.color = in.iColor;
 
-    float2 worldPos = in.iPosition.xy + v.pos + data.pos;
+    float2 worldPos = in.iRect.xy + corner * in.iRect.zw;
     out.position = transform.uProjection * float4(worldPos, 0.0, 1.0);
 
     return out;
@@ -72,10 +57,10 @@ vertex VertexOut vertex_main(
 // ----------------------------
 fragment float4 fragment_main(VertexOut in [[stage_in]],
                               texture2d<float> tex [[texture(0)]],
-                              sampler texSampler [[sampler(0)]],
-                              constant Data& data [[buffer(11)]])
+                              sampler texSampler [[sampler(0)]])
 {
-    float alpha = tex.sample(texSampler, in.fragUV).r;
+    float2 size = float2(tex.get_width(), tex.get_height());
+    float alpha = tex.sample(texSampler, in.fragTex / size).r;
     return float4(in.color.rgb, alpha);
 
     //return float4(1, 1, 1, 1);
@@ -9,12 +9,6 @@ struct Transform
     float4x4 uProjection;
 };
 
-// Uniform color (binding = 1)
-struct Data
-{
-    float4 uColor; // (r,g,b,a)
-};
-
 // --- Vertex Input / Output ---
 
 struct VertexIn
@@ -32,14 +26,12 @@ struct VertexOut
 // --- Vertex Shader ---
 
 vertex VertexOut vertex_main(VertexIn in [[stage_in]],
-                             constant Transform& transform [[buffer(10)]],
-                             constant Data& data [[buffer(11)]])
+                             constant Transform& transform [[buffer(10)]])
 {
     VertexOut out;
     out.position = transform.uProjection * float4(in.aPos, 0.0, 1.0);
 
-    // Proper override: if vertex color is empty (alpha == 0), use uniform color instead.
-    out.vColor = (in.aColor.a != 0.0) ? in.aColor : data.uColor;
+    out.vColor = in.aColor;
 
     return out;
 }
@@ -0,0 +1,92 @@
+#version 430 core
+
+// One instance per window of a polyline stream: the points before, at either end of,
+// and after a segment. Separators (negative alpha) end lines.
+layout(location = 0) in vec3 iPrev;         // x, y, width
+layout(location = 1) in vec4 iPrevColor;
+layout(location = 2) in vec3 iStart;
+layout(location = 3) in vec4 iStartColor;
+layout(location = 4) in vec3 iEnd;
+layout(location = 5) in vec4 iEndColor;
+layout(location = 6) in vec3 iNext;
+layout(location = 7) in vec4 iNextColor;
+
+layout(std140, binding = 0) uniform Transform {
+    mat4 uProjection;
+};
+
+out vec4 vColor;
+
+// Follows expandSegment() (TriangulatePolyline.hpp), which the CPU path uses. The tests
+// check a port of this against it (polylineVertex), so keep the two in step.
+void main() {
+
+    // Not a segment, nothing to draw
+    if (iStartColor.a < 0.0 || iEndColor.a < 0.0) {
+        vColor = vec4(0.0);
+        gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+
+    float halfT = iStart.z * 0.5;
+
+    vec2 A = iPrev.xy, B = iStart.xy, C = iEnd.xy, D = iNext.xy;
+
+    // Direction and (half thickness) normal
+    vec2 u = (C - B) / length(C - B);
+    vec2 h = vec2(-u.y, u.x) * halfT;
+
+    vec2 a = B + h, b = B - h, c = C - h, d = C + h;
+
+    // Inside of the join with the previous segment
+    if (iPrevColor.a >= 0.0) {
+
+        vec2 pu = (B - A) / length(B - A);
+        vec2 ph = vec2(-pu.y, pu.x) * halfT;
+
+        float cross = pu.x * u.y - pu.y * u.x;
+        float side = cross < 0.0 ? -1.0 : 1.0;
+
+        vec2 i1 = A + side * ph;
+        vec2 i2 = B + side * h;
+
+        float t = ((i2.x - i1.x) * u.y - (i2.y - i1.y) * u.x) / cross;
+        vec2 join = abs(cross) > 1e-3 ? i1 + pu * t : i2;
+
+        if (cross < 0.0) { b = join; }
+        else { a = join; }
+    }
+
+    // Join with the next segment (the triangle is empty without one)
+    vec2 o1 = C, o2 = C, join = C;
+
+    if (iNextColor.a >= 0.0) {
+
+        vec2 nu = (D - C) / length(D - C);
+        vec2 nh = vec2(-nu.y, nu.x) * halfT;
+
+        float cross = u.x * nu.y - u.y * nu.x;
+        float side = cross < 0.0 ? -1.0 : 1.0;
+
+        vec2 i1 = B + side * h;
+        vec2 i2 = C + side * nh;
+
+        float t = ((i2.x - i1.x) * nu.y - (i2.y - i1.y) * nu.x) / cross;
+        join = abs(cross) > 1e-3 ? i1 + u * t : i2;
+
+        if (cross < 0.0) { c = join; }
+        else { d = join; }
+
+        o1 = C - side * h;
+        o2 = C - side * nh;
+    }
+
+    // Quad, then join triangle
+    vec2 corners[9] = vec2[](a, b, c, a, c, d, o1, o2, join);
+
+    int vid = gl_VertexID % 9;
+
+    // Start takes the color of B, the rest that of C
+    vColor = (vid == 0 || vid == 1 || vid == 3) ? iStartColor : iEndColor;
+    gl_Position = uProjection * vec4(corners[vid], 0.0, 1.0);
+}
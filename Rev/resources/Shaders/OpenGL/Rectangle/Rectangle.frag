@@ -3,12 +3,9 @@
 in vec2 fragLocalPos;
 out vec4 FragColor;
 
-layout(std140, binding = 1) uniform Data {
-    float x, y, w, h;       // Rect
-    float r, g, b, a;       // Color
-    float tl, tr, bl, br;   // Corner radii
-    float depth, pad1, pad2, pad3;
-};
+flat in vec4 fragRect;
+flat in vec4 fragColor;
+flat in vec4 fragCorners;
 
 float roundedBoxSDF(vec2 p, vec2 halfSize, float radius) {
     vec2 q = abs(p) - halfSize + vec2(radius);
@@ -16,6 +13,10 @@ float roundedBoxSDF(vec2 p, vec2 halfSize, float radius) {
 }
 
 void main() {
+
+    float x = fragRect.x, y = fragRect.y, w = fragRect.z, h = fragRect.w;
+    float tl = fragCorners.x, tr = fragCorners.y, bl = fragCorners.z, br = fragCorners.w;
+
     vec2 rectCenter = vec2(x + w * 0.5, y + h * 0.5);
     vec2 localPos = fragLocalPos - rectCenter;
     vec2 halfSize = vec2(w, h) * 0.5;
@@ -51,7 +52,6 @@ void main() {
     float alpha = 1.0 - smoothstep(-smoothing, smoothing, dist);
     if (alpha < 0.01) { discard; }
 
-    // Output color and depth
-    FragColor = vec4(r, g, b, a * alpha);
-    gl_FragDepth = depth;
+    // Output color
+    FragColor = vec4(fragColor.rgb, fragColor.a * alpha);
 }
\ No newline at end of file
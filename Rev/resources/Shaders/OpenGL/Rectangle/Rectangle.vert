@@ -1,35 +1,38 @@
 #version 430 core
 
-layout(location = 0) in float dummyVertexID; // just to enable draw call
+layout(location = 0) in vec4 iRect;     // x, y, w, h
+layout(location = 1) in vec4 iColor;    // r, g, b, a
+layout(location = 2) in vec4 iCorners;  // Corner radii (tl, tr, bl, br)
 
 layout(std140, binding = 0) uniform Transform {
     mat4 uProjection;
 };
 
-layout(std140, binding = 1) uniform Data {
-    float x, y, w, h;       // Rect
-    float r, g, b, a;       // Color
-    float tl, tr, bl, br;   // Corner radii
-    float depth, pad1, pad2, pad3;
-};
-
 out vec2 fragLocalPos;
-out vec4 fragColor;
+
+flat out vec4 fragRect;
+flat out vec4 fragColor;
+flat out vec4 fragCorners;
 
 void main() {
 
-    const vec2 offsets[4] = vec2[](
+    // Two triangles per rectangle
+    const vec2 offsets[6] = vec2[](
         vec2(0.0, 0.0), // Top-left
         vec2(1.0, 0.0), // Top-right
         vec2(1.0, 1.0), // Bottom-right
+        vec2(0.0, 0.0), // Top-left
+        vec2(1.0, 1.0), // Bottom-right
         vec2(0.0, 1.0)  // Bottom-left
     );
 
-    vec2 cornerOffset = offsets[gl_VertexID];
-    vec2 position = vec2(x, y) + cornerOffset * vec2(w, h);
+    vec2 cornerOffset = offsets[gl_VertexID % 6];
+    vec2 position = iRect.xy + cornerOffset * iRect.zw;
 
     fragLocalPos = position; // local within rect
-    fragColor = vec4(r, g, b, a);
+    fragRect = iRect;
+    fragColor = iColor;
+    fragCorners = iCorners;
 
     gl_Position = uProjection * vec4(position, 0.0, 1.0);
 }
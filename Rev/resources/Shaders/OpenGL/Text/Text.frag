@@ -1,21 +1,15 @@
 #version 430 core
 
-in vec2 fragUV;
+in vec2 fragTex;
+flat in vec4 fragColor;
 out vec4 FragColor;
 
 // Texture sampler bound at texture unit 0
 layout(binding = 0) uniform sampler2D tex;
 
-// Per-instance color data bound at UBO binding 1
-layout(std140, binding = 1) uniform Data {
-    vec4 color;
-    vec2 pos;
-    float depth, pad1;
-};
-
 void main() {
 
-    float a = texture(tex, fragUV).r;
+    float a = texture(tex, fragTex / vec2(textureSize(tex, 0))).r;
 
     // --- Hard contrast reconstruction ---
     // Center threshold around 0.5 with a very narrow blend band
@@ -24,6 +18,5 @@ void main() {
 
     float punchy = smoothstep(lo, hi, a + 0.05);
 
-    FragColor = vec4(color.rgb, punchy * color.a);
-    gl_FragDepth = depth;
+    FragColor = vec4(fragColor.rgb, punchy * fragColor.a);
 }
\ No newline at end of file
@@ -1,39 +1,31 @@
 #version 430 core
 
-layout(location = 0) in vec4 iPosition;  // xy = position, z = glyph index (float), w = unused
+layout(location = 0) in vec4 iRect;   // xy = glyph position, zw = glyph size
+layout(location = 1) in vec4 iTex;    // xy = atlas position, zw = atlas size (pixels)
+layout(location = 2) in vec4 iColor;
 
 layout(std140, binding = 0) uniform Transform {
     mat4 uProjection;
 };
 
-// Per-instance color data bound at UBO binding 1
-layout(std140, binding = 1) uniform Data {
-    vec4 color;
-    vec2 pos;
-    float depth, pad1;
-};
-
-struct CharVertex {
-    vec2 pos;
-    vec2 uv;
-};
-
-layout(std140, binding = 2) uniform GlyphData {
-    CharVertex glyphs[128 * 6];
-};
+// Two triangles per glyph
+const vec2 corners[6] = vec2[6](
+    vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),
+    vec2(0.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0)
+);
 
-out vec2 fragUV;
+out vec2 fragTex;
+flat out vec4 fragColor;
 
 void main() {
 
-    int glyphIndex = int(iPosition.z);
-    int corner = gl_VertexID % 6;
+    vec2 corner = corners[gl_VertexID % 6];
 
-    int index = glyphIndex * 6 + corner;
+    // Atlas coords stay in pixels, so the atlas can grow without touching instances
+    fragTex = iTex.xy + corner * iTex.zw;
 
-    CharVertex v = glyphs[index];
-    fragUV = v.uv;
+    fragColor = iColor;
 
-    vec2 worldPos = iPosition.xy + v.pos + pos;
+    vec2 worldPos = iRect.xy + corner * iRect.zw;
     gl_Position = uProjection * vec4(worldPos, 0.0, 1.0);
-}
\ No newline at end of file
+}
@@ -7,17 +7,11 @@ layout(std140, binding = 0) uniform Transform {
     mat4 uProjection;
 };
 
-layout(std140, binding = 1) uniform Data {
-    vec4 uColor;
-    float depth, pad1, pad2, pad3;
-};
-
 out vec4 vColor;
 
 void main()
 {
-    // If uColor.a != 0.0, use the uniform color; otherwise use the vertex color.
-    vColor = (aColor.a != 0.0) ? aColor : uColor;
+    vColor = aColor;
 
     gl_Position = uProjection * vec4(aPos, 0.0, 1.0);
 }
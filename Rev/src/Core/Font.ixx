@@ -1,10 +1,16 @@
 module;
 
 #include <cmath>
-#include <vector>
 #include <map>
-#include <stdexcept>
+#include <array>
+#include <tuple>
+#include <string>
+#include <vector>
+#include <cstdint>
 #include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -12,9 +18,9 @@ module;
 export module Rev.Core.Font;
 
 import Rev.Core.Resource;
+import Rev.Core.Shared;
 
 import Rev.Graphics.Canvas;
-import Rev.Graphics.UniformBuffer;
 import Rev.Graphics.Texture;
 
 import Resources.Fonts.Arial.Arial_ttf;
@@ -23,24 +29,261 @@ export namespace Rev::Core {
 
     using namespace Rev::Graphics;
 
+    // Glyph atlas
+    //--------------------------------------------------
+
+    // A single-channel bitmap shared by every font, which grows downward a page at a time.
+    // Glyphs are packed into rows (shelves) as they are first used, and only the rows
+    // which changed are sent to the GPU. Regions of fonts no longer used are reused.
+    //
+    // (Its texture lives on the context of the first canvas to use a font, as the primitives'
+    // pipelines and batches do, so text is drawn in one window only)
+    struct Atlas {
+
+        static constexpr size_t width = 1024;
+        static constexpr size_t pageHeight = 256;
+        static constexpr size_t padding = 4;
+
+        struct Region {
+            size_t x = 0, y = 0;
+            size_t w = 0, h = 0;
+        };
+
+        void* context = nullptr;
+        Texture* texture = nullptr;
+
+        size_t height = 0;
+        std::vector<unsigned char> bitmap;
+
+        // Shelf packing
+        size_t penX = padding, penY = padding;
+        size_t rowHeight = 0;
+
+        // Rows awaiting upload
+        size_t dirtyStart = 0, dirtyEnd = 0;
+        bool resized = false;
+
+        // Regions given back by evicted fonts
+        std::vector<Region> freed;
+
+        // Create
+        Atlas(void* context) : context(context) {
+            this->grow(pageHeight);
+        }
+
+        // Destroy
+        ~Atlas() {
+            delete texture;
+        }
+
+        // Reserve space for a glyph, adding pages as needed
+        Region allocate(size_t w, size_t h) {
+
+            if (w + 2 * padding > width) {
+                throw std::runtime_error("Glyph too wide for atlas");
+            }
+
+            // Smallest freed region the glyph fits in
+            auto best = freed.end();
+
+            for (auto it = freed.begin(); it != freed.end(); it++) {
+                if (it->w < w || it->h < h) { continue; }
+                if (best == freed.end() || it->w * it->h < best->w * best->h) { best = it; }
+            }
+
+            if (best != freed.end()) {
+
+                Region from = *best;
+                freed.erase(best);
+
+                this->split(from, w, h);
+
+                return { from.x, from.y, w, h };
+            }
+
+            // Start a new row on overflow
+            if (penX + w + padding > width) {
+                penX = padding;
+                penY += rowHeight + padding;
+                rowHeight = 0;
+            }
+
+            // Add pages until the glyph fits
+            if (penY + h + padding > height) {
+                size_t pages = (penY + h + padding - height + pageHeight - 1) / pageHeight;
+                this->grow(height + pages * pageHeight);
+            }
+
+            Region region = { penX, penY, w, h };
+
+            penX += w + padding;
+            rowHeight = std::max(rowHeight, h);
+
+            return region;
+        }
+
+        // Give back what a glyph taking the top left of a freed region leaves of it (padded, in two
+        // parts, cut along the shorter side left over so the larger part stays whole)
+        void split(Region& from, size_t w, size_t h) {
+
+            size_t restW = (from.w > w + padding) ? from.w - w - padding : 0;
+            size_t restH = (from.h > h + padding) ? from.h - h - padding : 0;
+
+            Region right, below;
+
+            if (from.w - w < from.h - h) {
+                right = { from.x + w + padding, from.y, restW, h };
+                below = { from.x, from.y + h + padding, from.w, restH };
+            }
+
+            else {
+                right = { from.x + w + padding, from.y, restW, from.h };
+                below = { from.x, from.y + h + padding, w, restH };
+            }
+
+            for (Region rest : { right, below }) {
+                if (rest.w && rest.h) { freed.push_back(rest); }
+            }
+        }
+
+        // Copy glyph bitmap into atlas
+        void write(Region& region, const unsigned char* src, int pitch) {
+
+            for (size_t y = 0; y < region.h; y++) {
+                std::memcpy(&bitmap[(region.y + y) * width + region.x], src + y * pitch, region.w);
+            }
+
+            // Expand the range of rows awaiting upload
+            if (dirtyEnd <= dirtyStart) { dirtyStart = region.y; dirtyEnd = region.y + region.h; }
+            else { dirtyStart = std::min(dirtyStart, region.y); dirtyEnd = std::max(dirtyEnd, region.y + region.h); }
+        }
+
+        // Give a region back (cleared, as a smaller glyph may take it)
+        void free(Region& region) {
+
+            for (size_t y = 0; y < region.h; y++) {
+                std::memset(&bitmap[(region.y + y) * width + region.x], 0, region.w);
+            }
+
+            if (dirtyEnd <= dirtyStart) { dirtyStart = region.y; dirtyEnd = region.y + region.h; }
+            else { dirtyStart = std::min(dirtyStart, region.y); dirtyEnd = std::max(dirtyEnd, region.y + region.h); }
+
+            freed.push_back(region);
+        }
+
+        // Add rows (existing rows, and so existing glyph regions, are preserved)
+        void grow(size_t newHeight) {
+            bitmap.resize(width * newHeight, 0);
+            height = newHeight;
+            resized = true;
+        }
+
+        // Send pending changes to the GPU
+        void upload() {
+
+            // (Re)allocate texture with the whole bitmap
+            if (!texture || resized) {
+
+                if (!texture) {
+                    texture = new Texture(context, {
+                        .data = bitmap.data(),
+                        .width = width, .height = height,
+                        .channels = 1
+                    });
+                }
+
+                else { texture->resize(bitmap.data(), width, height); }
+
+                resized = false;
+                dirtyStart = dirtyEnd = 0;
+
+                return;
+            }
+
+            // Only the rows which changed
+            if (dirtyEnd > dirtyStart) {
+                texture->update(bitmap.data(), 0, dirtyStart, width, dirtyEnd - dirtyStart);
+                dirtyStart = dirtyEnd = 0;
+            }
+        }
+    };
+
+    // Font
+    //--------------------------------------------------
+
     struct Font {
 
+        // Font cache
+        //--------------------------------------------------
+
+        // Fonts are shared by resource, pixel size and scale
+        using Key = std::tuple<const unsigned char*, float, float>;
+
+        inline static std::map<Key, Font*> cache;
+        inline static Shared shared;
+
+        // Shared by all fonts
+        inline static FT_Library ft = nullptr;
+        inline static Atlas* atlas = nullptr;
+
+        // Get a (possibly existing) font, must be released
+        static Font* acquire(Canvas* canvas, Resource resource = Arial_ttf, float size = 12.0f, float scale = 1.0f) {
+
+            shared.create([canvas]() {
+
+                if (FT_Init_FreeType(&ft)) {
+                    throw std::runtime_error("Failed to initialize FreeType");
+                }
+
+                atlas = new Atlas(canvas->context);
+            });
+
+            Font*& font = cache[{ resource.data, size * scale, scale }];
+            if (!font) { font = new Font(resource, size, scale); }
+
+            font->users += 1;
+
+            return font;
+        }
+
+        // Stop using a font. Once no one does, it leaves the cache and its glyphs' regions
+        // are given back to the atlas.
+        static void release(Font* font) {
+
+            if (!font) { return; }
+
+            if (--font->users == 0) {
+                cache.erase({ font->resource.data, font->size * font->scale, font->scale });
+                delete font;
+            }
+
+            shared.destroy([]() {
+
+                delete atlas;
+                atlas = nullptr;
+
+                FT_Done_FreeType(ft);
+                ft = nullptr;
+            });
+        }
+
         // Font details
         //--------------------------------------------------
 
         // The font resource
         Resource resource = Arial_ttf;
+        size_t users = 0;
 
-        // FreeType handles
-        inline static FT_Library ft = nullptr;
-        inline static size_t users = 0;
+        // Unique among all fonts created (unlike addresses, which are reused)
+        size_t id = 0;
+        inline static size_t created = 0;
+
+        // FreeType handle
         FT_Face face = nullptr;
+        bool kerns = false;
 
         // Font attributes
         float scale = 1.0f;
-        const int padding = 4;
-        const float rPadding = 0;
-
         float size = 12.0f;
         int weight = 200;
         float ascent, descent;
@@ -51,59 +294,27 @@ export namespace Rev::Core {
 
         struct Glyph {
 
-            size_t index;
+            bool loaded = false;
+            unsigned int index = 0;
 
-            float width, height;
+            float width = 0, height = 0;
 
-            float bearingX, bearingY;
-            float advance;
-            
-            float kerning[256] = { 0.0f };
-
-            float u0, v0, u1, v1; // Texture coords
-        };
-
-        std::vector<Glyph> glyphs;
-
-        // Bitmap texture
-        //--------------------------------------------------
-
-        struct Bitmap {
-            
-            size_t width, height;
-            size_t size;
-
-            unsigned char* data = nullptr;
-        };
-
-        Bitmap bitmap;
-        Texture* texture = nullptr;
-
-        // Glyph data
-        //--------------------------------------------------
-
-        // Position and texture coords
-        struct CharVertex {
-            float x, y;
-            float u, v;
-        };
+            float bearingX = 0, bearingY = 0;
+            float advance = 0;
 
-        // Six vertices per quad
-        struct GlyphData {
-            CharVertex a, b, c, d, e, f;
+            Atlas::Region region;
         };
 
-        UniformBuffer* glyphData = nullptr;
+        // ASCII is looked up directly, anything else by codepoint
+        std::array<Glyph, 128> ascii;
+        std::unordered_map<char32_t, Glyph> glyphs;
+        std::unordered_map<uint64_t, float> kerning;
 
-        Font(Canvas* canvas, Resource resource = Arial_ttf, float size = 12.0f, float scale = 1.0f) : resource(resource) {
+        Font(Resource resource, float size, float scale) : resource(resource) {
 
             this->size = size;
             this->scale = scale;
-            
-            // Initialize freetype if we are the first user
-            if (++users == 1 && FT_Init_FreeType(&ft)) {
-                throw std::runtime_error("Failed to initialize FreeType");
-            }
+            this->id = ++created;
 
             // Load font face from memory (resource data)
             if (FT_New_Memory_Face(ft, resource.data, static_cast<FT_Long>(resource.size), 0, &face)) {
@@ -115,54 +326,23 @@ export namespace Rev::Core {
                 throw std::runtime_error("Failed to set font pixel size");
             }
 
-            glyphs.resize(256);
+            kerns = FT_HAS_KERNING(face);
 
             this->getFontAttribs();
-            this->bake();
-
-            texture = new Texture(canvas->context, {
-                .data = bitmap.data,
-                .width = bitmap.width, .height = bitmap.height,
-                .channels = 1
-            });
-
-            // Make glyph data ubo
-            //--------------------------------------------------
-
-            glyphData = new UniformBuffer(canvas->context, sizeof(GlyphData) * 128);
-            GlyphData* glyphDataArr = static_cast<GlyphData*>(glyphData->data);
-
-            for (char c = 0; c < 127; c++) {
-
-                Font::Quad q = this->getRelativeQuad(c);
-
-                glyphDataArr[c] = {
-
-                    // Triangle 1
-                    { q.x0, q.y0, q.s0, q.t0 },
-                    { q.x1, q.y0, q.s1, q.t0 },
-                    { q.x1, q.y1, q.s1, q.t1 },
-    
-                    // Triangle 2
-                    { q.x0, q.y0, q.s0, q.t0 },
-                    { q.x1, q.y1, q.s1, q.t1 },
-                    { q.x0, q.y1, q.s0, q.t1 }
-                };
-            }
         }
 
         ~Font() {
 
-            // Delete our resources
-            if (face) { FT_Done_Face(face); }
-            if (bitmap.data) { delete[] bitmap.data; }
-            if (texture) { delete texture; }
-            if (glyphData) { delete glyphData; }
+            // Glyphs go with us
+            for (Glyph& glyph : ascii) {
+                if (glyph.region.w) { atlas->free(glyph.region); }
+            }
 
-            // Delete freetype if we are the last user
-            if (--users == 0 && ft) {
-                FT_Done_FreeType(ft);
+            for (auto& [c, glyph] : glyphs) {
+                if (glyph.region.w) { atlas->free(glyph.region); }
             }
+
+            if (face) { FT_Done_Face(face); }
         }
 
         // Get font face atributes
@@ -173,150 +353,94 @@ export namespace Rev::Core {
             descent = (1.0f / scale) * fabs(face->size->metrics.descender / 64.0f);
             lineGap = (1.0f / scale) * (face->size->metrics.height - (face->size->metrics.ascender - face->size->metrics.descender)) / 64.0f;
             lineHeight = (1.0f / scale) * face->size->metrics.height / 64.0f;
+        }
 
-            // Glyphs
-            //--------------------------------------------------
+        // Get glyph, rasterizing it into the atlas on first use
+        Glyph& glyph(char32_t c) {
 
-            for (size_t i = 0; i < 127; i++) {
-                glyphs[i].index = FT_Get_Char_Index(face, static_cast<FT_ULong>(i));
-            }
+            Glyph& g = (c < 128) ? ascii[c] : glyphs[c];
 
-            // Kerning
-            //--------------------------------------------------
+            if (!g.loaded) { this->load(c, g); }
 
-            if (!FT_HAS_KERNING(face) ) { return; }
+            return g;
+        }
 
-            // Compute for left/right combos
-            for (size_t l = 0; l < 127; l++) {
-                for (size_t r = 0; r < 127; r++) {
+        // Rasterize a single glyph
+        void load(char32_t c, Glyph& glyph) {
 
-                    Glyph& left = glyphs[l];
-                    Glyph& right = glyphs[r];
+            glyph.loaded = true;
 
-                    FT_Vector delta = { 0, 0 };
-                    FT_Get_Kerning(face, left.index, right.index, FT_KERNING_DEFAULT, &delta);
-                    
-                    right.kerning[left.index] = (1.0f / scale) * static_cast<float>(delta.x) / 64.0f;
-                }
+            // Control characters take no space
+            if (c < 32) { return; }
+
+            glyph.index = FT_Get_Char_Index(face, static_cast<FT_ULong>(c));
+
+            if (FT_Load_Glyph(face, glyph.index, FT_LOAD_RENDER)) {
+                return;
             }
-        }
 
-        // A crucial part of font rendering is pre-baking the font into a bitmap texture
-        // which can be fed to the GPU, and for each glyph the texture coordinates thereof
-        // being used to write said glyph at the correct position on the screen.
-        void bake() {
-        
-            int penX = padding;
-            int penY = padding;
-            int rowHeight = 0;
-
-            bitmap.width = 1024;
-            bitmap.height = 1024;
-            bitmap.size = bitmap.width * bitmap.height;
-            bitmap.data = new unsigned char[bitmap.size];
-            std::memset(bitmap.data, 0, bitmap.size);
-
-            for (char c = 32; c < 127; c++) {
-
-                if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
-                    continue;
-                }
+            FT_GlyphSlot g = face->glyph;
 
-                FT_GlyphSlot g = face->glyph;
+            glyph.width = (1.0f / scale) * float(g->bitmap.width);
+            glyph.height = (1.0f / scale) * float(g->bitmap.rows);
+            glyph.bearingX = (1.0f / scale) * float(g->bitmap_left);
+            glyph.bearingY = (1.0f / scale) * float(g->bitmap_top);
+            glyph.advance = (1.0f / scale) * float(g->advance.x) / 64.0f;
 
-                if (penX + g->bitmap.width + padding >= bitmap.width) {
-                    penX = padding;
-                    penY += rowHeight + padding;
-                    rowHeight = 0;
-                }
+            // Whitespace has nothing to draw
+            if (!g->bitmap.width || !g->bitmap.rows) { return; }
 
-                if (penY + g->bitmap.rows >= bitmap.height) {
-                    throw std::runtime_error("Font atlas overflowed");
-                }
+            glyph.region = atlas->allocate(g->bitmap.width, g->bitmap.rows);
+            atlas->write(glyph.region, g->bitmap.buffer, g->bitmap.pitch);
+        }
 
-                // Copy glyph bitmap into atlas
-                for (int y = 0; y < g->bitmap.rows; y++) {
-                    for (int x = 0; x < g->bitmap.width; x++) {
-                        int dst = (penX + x) + (penY + y) * bitmap.width;
-                        int src = x + y * g->bitmap.pitch;
-                        bitmap.data[dst] = g->bitmap.buffer[src];
-                    }
-                }
+        // Kerning between a pair of characters
+        float kern(char32_t left, char32_t right) {
 
-                Glyph& glyph = glyphs[c];
+            if (!kerns || !left) { return 0.0f; }
 
-                glyphs[c] = {
+            uint64_t pair = (uint64_t(left) << 32) | uint64_t(right);
 
-                    .width = (1.0f / scale) * float(g->bitmap.width),
-                    .height = (1.0f / scale) * float(g->bitmap.rows),
-                    .bearingX = (1.0f / scale) * float(g->bitmap_left),
-                    .bearingY = (1.0f / scale) * float(g->bitmap_top),
-                    .advance = (1.0f / scale) * float(g->advance.x) / 64.0f,
+            auto it = kerning.find(pair);
+            if (it != kerning.end()) { return it->second; }
 
-                    .u0 = (float(penX) - scale * rPadding) / bitmap.width,
-                    .v0 = (float(penY) - scale * rPadding) / bitmap.height,
-                    .u1 = (float(penX + g->bitmap.width) + scale * rPadding) / bitmap.width,
-                    .v1 = (float(penY + g->bitmap.rows) + scale * rPadding)/ bitmap.height
-                };
+            FT_Vector delta = { 0, 0 };
+            FT_Get_Kerning(face, glyph(left).index, glyph(right).index, FT_KERNING_DEFAULT, &delta);
 
-                penX += g->bitmap.width + padding;
-                rowHeight = std::max(rowHeight, static_cast<int>(g->bitmap.rows));
-            }
+            float value = (1.0f / scale) * static_cast<float>(delta.x) / 64.0f;
+            kerning[pair] = value;
 
-            bool test = true;
+            return value;
         }
 
-        // Lookup glyph and calculate quad position and texture coords
-        Glyph getGlyph(char c) const {
-            return glyphs[static_cast<unsigned char>(c)];
-        }
+        // Decode the UTF-8 character at idx, advancing idx past it
+        static char32_t next(const std::string& str, size_t& idx) {
 
-        struct Quad {
-            float x0, y0, s0, t0;
-            float x1, y1, s1, t1;
-        };
-        
-        Quad getQuad(char c, float& x, float& y, char prev = 0) {
-
-            const Glyph& g = glyphs[static_cast<unsigned char>(c)];
-        
-            float kerning = glyphs[prev].kerning[c];
-
-            x += kerning;
-
-            float x0 = x + g.bearingX;
-            float y0 = y - g.bearingY;
-            float x1 = x0 + g.width;
-            float y1 = y0 + g.height;
-        
-            Quad q = {
-                .x0 = x0, .y0 = y0, .s0 = g.u0, .t0 = g.v0,
-                .x1 = x1, .y1 = y1, .s1 = g.u1, .t1 = g.v1
-            };
-        
-            x += g.advance;
-            return q;
-        }
+            unsigned char lead = static_cast<unsigned char>(str[idx++]);
+
+            // Single byte (ASCII)
+            if (lead < 0x80) { return lead; }
+
+            // Determine length from lead byte
+            size_t extra = 0;
+            char32_t c = 0;
+
+            if ((lead & 0xE0) == 0xC0) { extra = 1; c = lead & 0x1F; }
+            else if ((lead & 0xF0) == 0xE0) { extra = 2; c = lead & 0x0F; }
+            else if ((lead & 0xF8) == 0xF0) { extra = 3; c = lead & 0x07; }
+            else { return 0xFFFD; }
+
+            // Continuation bytes
+            for (size_t i = 0; i < extra; i++) {
+
+                if (idx >= str.size() || (static_cast<unsigned char>(str[idx]) & 0xC0) != 0x80) {
+                    return 0xFFFD;
+                }
+
+                c = (c << 6) | (static_cast<unsigned char>(str[idx++]) & 0x3F);
+            }
 
-        Quad getRelativeQuad(char c, char prev = 0) {
-            
-            const Glyph& g = glyphs[static_cast<unsigned char>(c)];
-        
-            // Optional: kerning between prev and c, not strictly needed for static glyph data
-            float kerning = glyphs[static_cast<unsigned char>(prev)].kerning[c];
-        
-            float penX = 0.0f;
-            float penY = 0.0f;
-        
-            float x0 = penX + g.bearingX - scale * rPadding;
-            float y0 = penY - g.bearingY - scale * rPadding;
-            float x1 = x0 + g.width + 2.0f * scale * rPadding;
-            float y1 = y0 + g.height + 2.0f * scale * rPadding;
-        
-            return {
-                .x0 = x0, .y0 = y0, .s0 = g.u0, .t0 = g.v0,
-                .x1 = x1, .y1 = y1, .s1 = g.u1, .t1 = g.v1
-            };
+            return c;
         }
     };
-};
\ No newline at end of file
+};
@@ -79,10 +79,23 @@ export namespace Rev::Core {
             return true;
         }
 
+        // Return the overlap of two rects (with no size if they don't overlap)
+        Rect intersection(Rect& other) {
+
+            float left = std::max(x, other.x);
+            float top = std::max(y, other.y);
+            float right = std::min(x + w, other.x + other.w);
+            float bottom = std::min(y + h, other.y + other.h);
+
+            return Rect(left, top, std::max(0.0f, right - left), std::max(0.0f, bottom - top));
+        }
+
         // Transform relative position to absolute position, relative to this rect
         Pos relToAbs(Pos& pos) { return { x + pos.x * w,  y + pos.y * h }; }
         Vertex relToAbs(Vertex& vert) { return { x + vert.x * w,  y + vert.y * h }; }
 
+        bool operator==(const Rect& other) const = default;
+
         inline operator bool() const {
             return !(x || y || w || h);
         }
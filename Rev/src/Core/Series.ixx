@@ -0,0 +1,220 @@
+module;
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+export module Rev.Core.Series;
+
+import Rev.Core.Pos;
+import Rev.Core.Vertex;
+
+export namespace Rev::Core {
+
+    // A streaming series of samples (x must not decrease), kept in a ring buffer of limited
+    // capacity alongside a min/max pyramid, so any range can be drawn at screen resolution.
+    //
+    // Level k of the pyramid holds the min and max of each aligned run of 2^k samples.
+    // A level's bucket is built from two buckets of the level below when it completes,
+    // so appending is O(1) amortized.
+    struct Series {
+
+        struct Bucket {
+            Pos min, max;
+        };
+
+        // Samples / buckets ever appended (absolute index of next)
+        uint64_t total = 0;
+        size_t capacity = 0;
+
+        std::vector<Pos> samples;
+        std::vector<std::vector<Bucket>> levels;
+
+        // Create
+        Series(size_t capacity = 1 << 20) {
+            this->setCapacity(capacity);
+        }
+
+        // Change capacity (this clears the series)
+        void setCapacity(size_t newCapacity) {
+
+            capacity = std::max(newCapacity, size_t(2));
+            this->clear();
+
+            // Enough levels that the top holds a bucket or two
+            size_t numLevels = 1;
+            while ((size_t(1) << numLevels) < capacity) { numLevels += 1; }
+
+            levels.resize(numLevels);
+        }
+
+        void clear() {
+
+            total = 0;
+            samples.clear();
+
+            for (std::vector<Bucket>& level : levels) { level.clear(); }
+        }
+
+        size_t size() {
+            return size_t(std::min<uint64_t>(total, capacity));
+        }
+
+        bool empty() {
+            return total == 0;
+        }
+
+        // Absolute index of oldest sample still held
+        uint64_t first() {
+            return total - size();
+        }
+
+        // Sample at absolute index
+        Pos& at(uint64_t idx) {
+            return samples[idx % capacity];
+        }
+
+        // Buckets held per level (one or two spare, since the oldest may be partially evicted)
+        size_t levelCapacity(size_t level) {
+            return (capacity >> level) + 2;
+        }
+
+        // Bucket at absolute index (in units of 2^level samples)
+        Bucket& bucket(size_t level, uint64_t idx) {
+            return levels[level - 1][idx % levelCapacity(level)];
+        }
+
+        // Appending
+        //--------------------------------------------------
+
+        void append(Pos sample) {
+
+            // Fill, then overwrite oldest
+            if (samples.size() < capacity) { samples.push_back(sample); }
+            else { at(total) = sample; }
+
+            total += 1;
+
+            // Complete any buckets this sample finishes (half the time none, a quarter one, ...)
+            for (size_t level = 1; level <= levels.size(); level++) {
+
+                if (total & ((uint64_t(1) << level) - 1)) { break; }
+
+                uint64_t idx = (total >> level) - 1;
+                Bucket merged = this->merge(level, idx);
+
+                std::vector<Bucket>& buckets = levels[level - 1];
+
+                if (buckets.size() < levelCapacity(level)) { buckets.push_back(merged); }
+                else { bucket(level, idx) = merged; }
+            }
+        }
+
+        // Combine the two halves of a bucket from the level below
+        Bucket merge(size_t level, uint64_t idx) {
+
+            Bucket a, b;
+
+            if (level == 1) {
+                a = { at(2 * idx), at(2 * idx) };
+                b = { at(2 * idx + 1), at(2 * idx + 1) };
+            }
+
+            else {
+                a = bucket(level - 1, 2 * idx);
+                b = bucket(level - 1, 2 * idx + 1);
+            }
+
+            return {
+                .min = (b.min.y < a.min.y) ? b.min : a.min,
+                .max = (b.max.y > a.max.y) ? b.max : a.max
+            };
+        }
+
+        // Querying
+        //--------------------------------------------------
+
+        // Absolute index of first sample with x >= value
+        uint64_t lowerBound(float value) {
+
+            uint64_t lo = first(), hi = total;
+
+            while (lo < hi) {
+                uint64_t mid = lo + (hi - lo) / 2;
+                if (at(mid).x < value) { lo = mid + 1; }
+                else { hi = mid; }
+            }
+
+            return lo;
+        }
+
+        // Absolute index of first sample with x > value
+        uint64_t upperBound(float value) {
+
+            uint64_t lo = first(), hi = total;
+
+            while (lo < hi) {
+                uint64_t mid = lo + (hi - lo) / 2;
+                if (at(mid).x <= value) { lo = mid + 1; }
+                else { hi = mid; }
+            }
+
+            return lo;
+        }
+
+        // Get points covering [left, right] at roughly two per column (the min and max of
+        // the samples under each column, in order), plus a sample either side of the range
+        void decimate(float left, float right, size_t columns, std::vector<Vertex>& out) {
+
+            out.clear();
+
+            if (empty()) { return; }
+
+            // Visible samples, and one beyond each edge
+            uint64_t start = lowerBound(left);
+            uint64_t end = upperBound(right);
+
+            if (start > first()) { start -= 1; }
+            if (end < total) { end += 1; }
+
+            // Coarsest level with no more than one bucket per column
+            uint64_t perColumn = (end - start) / std::max(columns, size_t(1));
+            size_t level = 0;
+
+            while (level < levels.size() && (uint64_t(1) << level) < perColumn) { level += 1; }
+
+            // Cover the range with the largest aligned buckets up to that level
+            // (only the ends need finer ones)
+            uint64_t idx = start;
+
+            while (idx < end) {
+
+                size_t l = level;
+
+                while (l > 0 && ((idx & ((uint64_t(1) << l) - 1)) || idx + (uint64_t(1) << l) > end)) {
+                    l -= 1;
+                }
+
+                if (l == 0) {
+                    Pos& sample = at(idx);
+                    out.push_back({ sample.x, sample.y });
+                }
+
+                // Min and max, in order of x
+                else {
+
+                    Bucket& b = bucket(l, idx >> l);
+
+                    Pos& a = (b.min.x <= b.max.x) ? b.min : b.max;
+                    Pos& z = (b.min.x <= b.max.x) ? b.max : b.min;
+
+                    out.push_back({ a.x, a.y });
+                    out.push_back({ z.x, z.y });
+                }
+
+                idx += uint64_t(1) << l;
+            }
+        }
+    };
+};
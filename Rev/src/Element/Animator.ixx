@@ -0,0 +1,223 @@
+module;
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+export module Rev.Element.Animator;
+
+export namespace Rev::Element {
+
+    // Every running animation of a window, each a track moving a single style value (float)
+    // from one value to another. Tracks are kept in packed arrays, so advancing them all is
+    // one simple pass per frame, and are found by the value they move for retargeting.
+    //
+    // Tracks note whether they affect layout, so paint-only ones (colors etc.) only need
+    // their owner's primitives recomputed.
+    struct Animator {
+
+        enum Easing : uint8_t {
+            Linear, InOut
+        };
+
+        // Number of tracks an owner (element) has, and how many of those affect layout
+        struct Owner {
+            uint32_t tracks = 0;
+            uint32_t layoutTracks = 0;
+        };
+
+        // Tracks (the same index in each)
+        //--------------------------------------------------
+
+        std::vector<float*> subjects;
+        std::vector<void*> owners;
+
+        std::vector<float> from, to, values;
+        std::vector<float> starts, durations;      // (ms since epoch)
+
+        std::vector<uint8_t> easings;
+        std::vector<uint8_t> layouts;
+
+        // Lookup
+        //--------------------------------------------------
+
+        std::unordered_map<float*, uint32_t> index;
+        std::unordered_map<void*, Owner> counts;
+
+        // Owners of tracks advanced by the last frame, and those of them affecting layout
+        std::vector<void*> painted;
+        std::vector<void*> laidOut;
+
+        // Time of first track (to keep times small enough for floats)
+        uint64_t epoch = 0;
+
+        // While tracking, who for, when, and whether values affect layout
+        void* owner = nullptr;
+        float now = 0.0f;
+        bool layout = false;
+
+        size_t size() {
+            return subjects.size();
+        }
+
+        bool empty() {
+            return subjects.empty();
+        }
+
+        // Tracking
+        //--------------------------------------------------
+
+        // Start tracking the values of an owner, at a point in time
+        void begin(void* newOwner, uint64_t time) {
+
+            if (empty()) { epoch = time; }
+
+            owner = newOwner;
+            now = float(time - epoch);
+        }
+
+        // Called for a value which was just recomputed (so holds its target), with what it held
+        // before. Starts (or retargets) its track if needed, leaving it where the track has got to.
+        void track(float& subject, float old, int ms) {
+
+            // In flight (an owner without tracks has none to look up)
+            if (counts.contains(owner)) {
+
+                auto it = index.find(&subject);
+
+                if (it != index.end()) {
+
+                    uint32_t i = it->second;
+
+                    // Retarget, starting from where it has got to
+                    if (to[i] != subject) {
+                        from[i] = values[i];
+                        to[i] = subject;
+                        starts[i] = now;
+                        durations[i] = float(std::max(ms, 1));
+                    }
+
+                    subject = values[i];
+
+                    return;
+                }
+            }
+
+            if (ms < 1 || subject == old) { return; }
+
+            this->add(&subject, old, subject, float(ms));
+
+            subject = old;
+        }
+
+        void add(float* subject, float start, float end, float duration) {
+
+            index[subject] = uint32_t(subjects.size());
+
+            Owner& counted = counts[owner];
+            counted.tracks += 1;
+            counted.layoutTracks += layout;
+
+            subjects.push_back(subject);
+            owners.push_back(owner);
+
+            from.push_back(start);
+            to.push_back(end);
+            values.push_back(start);
+
+            starts.push_back(now);
+            durations.push_back(duration);
+
+            easings.push_back(InOut);
+            layouts.push_back(layout);
+        }
+
+        // Remove a track (the last takes its place)
+        void remove(size_t i) {
+
+            Owner& counted = counts[owners[i]];
+            counted.tracks -= 1;
+            counted.layoutTracks -= layouts[i];
+
+            if (!counted.tracks) { counts.erase(owners[i]); }
+
+            index.erase(subjects[i]);
+
+            size_t last = subjects.size() - 1;
+
+            if (i != last) {
+
+                subjects[i] = subjects[last]; owners[i] = owners[last];
+                from[i] = from[last]; to[i] = to[last]; values[i] = values[last];
+                starts[i] = starts[last]; durations[i] = durations[last];
+                easings[i] = easings[last]; layouts[i] = layouts[last];
+
+                index[subjects[i]] = uint32_t(i);
+            }
+
+            subjects.pop_back(); owners.pop_back();
+            from.pop_back(); to.pop_back(); values.pop_back();
+            starts.pop_back(); durations.pop_back();
+            easings.pop_back(); layouts.pop_back();
+        }
+
+        // Drop every track of an owner (which is going away, so must not be written to)
+        void forget(void* gone) {
+
+            // (Removing moves the last track into place, so the same index is looked at again)
+            for (size_t i = 0; i < subjects.size() && counts.contains(gone);) {
+                if (owners[i] == gone) { this->remove(i); }
+                else { i++; }
+            }
+
+            std::erase(painted, gone);
+            std::erase(laidOut, gone);
+        }
+
+        // Advancing
+        //--------------------------------------------------
+
+        // Move every track to a point in time, writing values to their subjects.
+        // Finished tracks are removed (after writing their final value).
+        void advance(uint64_t time) {
+
+            painted.clear();
+            laidOut.clear();
+
+            if (empty()) { return; }
+
+            float at = float(time - epoch);
+            size_t num = subjects.size();
+
+            // Progress and easing (branchless, over packed arrays)
+            for (size_t i = 0; i < num; i++) {
+
+                float t = std::clamp((at - starts[i]) / durations[i], 0.0f, 1.0f);
+
+                float sqr = t * t;
+                float inOut = sqr / (2.0f * (sqr - t) + 1.0f);
+                float eased = easings[i] == InOut ? inOut : t;
+
+                values[i] = from[i] + (to[i] - from[i]) * eased;
+            }
+
+            for (size_t i = 0; i < num; i++) {
+                *subjects[i] = values[i];
+            }
+
+            // Owners to update
+            for (auto& [animated, counted] : counts) {
+                painted.push_back(animated);
+                if (counted.layoutTracks) { laidOut.push_back(animated); }
+            }
+
+            // Retire finished tracks
+            for (size_t i = 0; i < subjects.size();) {
+                if (at >= starts[i] + durations[i]) { this->remove(i); }
+                else { i++; }
+            }
+        }
+    };
+};
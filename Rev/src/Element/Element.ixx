@@ -16,6 +16,7 @@ import Rev.Core.Pos;
 import Rev.Core.Rect;
 
 import Rev.Element.Style;
+import Rev.Element.Animator;
 import Rev.Element.Computed;
 import Rev.Element.Event;
 import Rev.Element.Resolved;
@@ -26,8 +27,11 @@ export namespace Rev::Element {
 
         struct Shared {
             std::vector<Element*> dirtyElements;
+            std::vector<Element*> deletedElements;      // (Until the window drops them from hit testing)
+            bool structureDirty = true;
             Graphics::Canvas* canvas = nullptr;
             Event* event = nullptr;
+            Animator animator;
         };
 
         // Shared betweeen elements
@@ -52,6 +56,15 @@ export namespace Rev::Element {
         size_t depth = 0;
         size_t scissor = false;
 
+        // Position within the window's cached queues (a subtree is a contiguous range in both)
+        size_t topDownIndex = 0;
+        size_t bottomUpIndex = 0;
+        size_t descendants = 0;
+
+        // Rect and frame at which primitives were last computed
+        Rect computedRect;
+        size_t computedFrame = 0;
+
         // Create
         Element(Element* parent = nullptr, std::string name = "Element") {
 
@@ -61,6 +74,7 @@ export namespace Rev::Element {
 
                 parent->children.push_back(this);
                 shared = parent->shared;
+                shared->structureDirty = true;
                 this->refresh(*shared->event);
             }
 
@@ -72,9 +86,30 @@ export namespace Rev::Element {
 
             //dbg("[Element] destroying");
 
-            // Remove all children
-            for (Element* child : children) { if (child) { delete child; } }
+            this->deleteChildren();
+
+            if (!shared) { return; }
+
+            // Nothing may refer to us once we're gone (animations would write to our style)
+            shared->animator.forget(this);
+            std::erase(shared->dirtyElements, this);
+            shared->deletedElements.push_back(this);
+
+            if (parent && parent != this) {
+                std::erase(parent->children, this);
+                shared->structureDirty = true;
+            }
+        }
+
+        // Remove all children (they leave with us, so needn't leave us one by one)
+        void deleteChildren() {
+
+            std::vector<Element*> leaving = std::move(children);
             children.clear();
+
+            for (Element* child : leaving) {
+                if (child) { child->parent = nullptr; delete child; }
+            }
         }
 
         // Cast as pointer to canvas
@@ -85,8 +120,6 @@ export namespace Rev::Element {
         // Computing
         //--------------------------------------------------
 
-        std::vector<Transition> transitions;
-
         // Comptue style
         virtual void computeStyle(Event& e) {
 
@@ -109,40 +142,10 @@ export namespace Rev::Element {
                 return;
             }
 
-            //return;
-
-            // Create transitions if needed
-            //--------------------------------------------------
-            
-            computed.style.animate(old, transitions, e.time);
-
-            // Transition styles
-            //--------------------------------------------------
-
-            // Remove expired transitions
-            transitions.erase(
-                std::remove_if(transitions.begin(), transitions.end(), [&](const Transition& transition) {
-                    return e.time > transition.endTime;
-                }),
-                transitions.end()
-            );
-
-            // Do transitions
-            for (Transition& transition : transitions) {
-
-                float& val = *transition.subject;
-
-                if (e.time < transition.startTime) { continue; }
-
-                if (e.time < transition.endTime) {
-                    float t = float((e.time - transition.startTime)) / float((transition.endTime - transition.startTime));
-                    val = Transition::ease(transition.startVal, transition.endVal, t);
-                }
-
-                if (e.time > transition.endTime) {
-                    val = transition.endVal;
-                }
-            }
+            // Start / retarget animations of values which changed (the window's animator
+            // moves them along from then on, without computing style again)
+            shared->animator.begin(this, e.time);
+            computed.style.animate(old, shared->animator);
         }
         
         // Compute attributes
@@ -159,11 +162,6 @@ export namespace Rev::Element {
             // Draw = no longer dirty
             this->dirty = false;
             draws += 1;
-
-            // If there are any incomplte transitions, we must continue drawing
-            if (!transitions.empty()) {
-                refresh(e);
-            }
         }
 
         // Layout
@@ -235,7 +233,13 @@ export namespace Rev::Element {
         Row* parentRow = nullptr;
         Resolved res;
 
-        // An optional function to measure dimensions (useful for text)
+        // Snapshots of res taken during layout, used to re-layout a subtree in isolation
+        Resolved relRes;        // After resolveRel (what our children resolve against)
+        Resolved promotedRes;   // After our descendants promoted (what our parent lays out with)
+        Resolved grownRes;      // Before resolveFlexDims (after our parent distributed space)
+
+        // An optional function to measure dimensions (useful for text), given the most space
+        // we may take, it sets our resolved size (before our parent's minima are resolved)
         bool measure = false;
         virtual void measureDims(float maxWidth, float maxHeight) {}
 
@@ -259,16 +263,21 @@ export namespace Rev::Element {
         }
 
         void resolveRel() {
+            resolveRel(parent->res);
+        }
+
+        // Resolve relative values against a given parent resolution
+        void resolveRel(Resolved& parentRes) {
 
             // Get maximum inner width/height of parent
-            float innerWidth = parent->res.getInner(Axis::Horizontal);
-            float innerHeight = parent->res.getInner(Axis::Vertical);
+            float innerWidth = parentRes.getInner(Axis::Horizontal);
+            float innerHeight = parentRes.getInner(Axis::Vertical);
 
-            float maxInnerWidth = parent->res.getMaxInner(Axis::Horizontal);
-            float maxInnerHeight = parent->res.getMaxInner(Axis::Vertical);
+            float maxInnerWidth = parentRes.getMaxInner(Axis::Horizontal);
+            float maxInnerHeight = parentRes.getMaxInner(Axis::Vertical);
             
-            float minInnerWidth = parent->res.getMinInner(Axis::Horizontal);
-            float minInnerHeight = parent->res.getMinInner(Axis::Vertical);
+            float minInnerWidth = parentRes.getMinInner(Axis::Horizontal);
+            float minInnerHeight = parentRes.getMinInner(Axis::Vertical);
 
             Style& rStyle = computed.style;
 
@@ -284,11 +293,18 @@ export namespace Rev::Element {
             // Inherit maxima from parent if none
             if (!set(res.size.w.max)) { res.size.w.max = maxInnerWidth; }
             if (!set(res.size.h.max)) { res.size.h.max = maxInnerHeight; }
+
+            relRes = res;
         }
 
         // Expand our minimum size if neccesary to accomodate children
         void resolveMinima() {
 
+            // If the element will be responsible for its own layout
+            if (measure) {
+                this->measureDims(res.getMaxInner(Axis::Horizontal), res.getMaxInner(Axis::Vertical));
+            }
+
             float minLayoutWidth = 0.0f;
 
             // Find maximum of all minimum child outer widths
@@ -395,11 +411,6 @@ export namespace Rev::Element {
                 layout.rows.push_back(row);
             }
 
-            // If the element will be responsible for its own layout
-            else {
-                this->measureDims(maxInnerWidth, maxInnerHeight);
-            }
-
             // Mark children as members of layout/row
             //--------------------------------------------------
 
@@ -455,6 +466,9 @@ export namespace Rev::Element {
         // Promote flex dimensions to allow parents to grow to accomodate children
         void promoteFlexDims() {
 
+            // All descendants have promoted by now
+            promotedRes = res;
+
             // Promote growable
             //--------------------------------------------------
 
@@ -480,6 +494,9 @@ export namespace Rev::Element {
         // Resolve grow/shrink
         void resolveFlexDims() {
 
+            // Our parent has distributed space by now
+            grownRes = res;
+
             // Resolve own padding and position (relative)
             //--------------------------------------------------
 
@@ -0,0 +1,162 @@
+module;
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+export module Rev.Element.HitGrid;
+
+import Rev.Core.Pos;
+import Rev.Core.Rect;
+
+import Rev.Element;
+import Rev.Element.Style;
+
+export namespace Rev::Element {
+
+    // Elements bucketed by the cells of a uniform grid (over the window) which their rect
+    // covers, so hit testing only looks at elements near a position. Rects are clipped by
+    // any ancestor which hides its overflow, as drawing is.
+    struct HitGrid {
+
+        struct Entry {
+
+            Rect area;          // Where the element can be hit
+            Rect scope;         // Where its children can be hit
+            bool visible = false;
+
+            // Cells covered (inclusive, none to begin with)
+            long x0 = 0, y0 = 0;
+            long x1 = -1, y1 = -1;
+        };
+
+        float cellSize = 64.0f;
+
+        Rect bounds;
+        long columns = 0, rows = 0;
+
+        std::vector<std::vector<Element*>> cells;
+        std::vector<Entry> entries;     // By top-down index
+
+        // Building
+        //--------------------------------------------------
+
+        // Place every element anew (the first is the window, whose rect the grid covers)
+        void rebuild(std::vector<Element*>& topDown) {
+
+            bounds = topDown.empty() ? Rect() : topDown[0]->rect;
+
+            columns = std::max(1L, long(std::ceil(bounds.w / cellSize)));
+            rows = std::max(1L, long(std::ceil(bounds.h / cellSize)));
+
+            cells.assign(columns * rows, {});
+            entries.assign(topDown.size(), Entry());
+
+            for (Element* element : topDown) { this->place(element); }
+        }
+
+        // Move an element whose rect or style changed (its parent must be up to date). If what
+        // it clips changed too, its descendants follow.
+        void update(Element* element, std::vector<Element*>& topDown) {
+
+            if (entries.size() != topDown.size()) { return this->rebuild(topDown); }
+
+            // The window changing size changes the grid
+            if (element->topDownIndex == 0 && !(element->rect == bounds)) { return this->rebuild(topDown); }
+
+            Rect scope = entries[element->topDownIndex].scope;
+
+            this->place(element);
+
+            if (entries[element->topDownIndex].scope == scope) { return; }
+
+            for (size_t i = element->topDownIndex + 1; i <= element->topDownIndex + element->descendants; i++) {
+                this->place(topDown[i]);
+            }
+        }
+
+        // Work out where an element can be hit, and move it to the cells covering that
+        void place(Element* element) {
+
+            Entry& entry = entries[element->topDownIndex];
+
+            // Clip to what our parent allows (the window allows itself)
+            Rect allowed = (element->topDownIndex == 0) ? bounds : entries[element->parent->topDownIndex].scope;
+
+            entry.area = element->rect.intersection(allowed);
+            entry.visible = entry.area.w > 0 && entry.area.h > 0;
+
+            bool hides = element->computed.style.overflow == Overflow::Hide;
+            entry.scope = hides ? entry.area : allowed;
+
+            // Cells now covered
+            long x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+
+            if (entry.visible) {
+                x0 = this->column(entry.area.x);
+                y0 = this->row(entry.area.y);
+                x1 = this->column(entry.area.x + entry.area.w);
+                y1 = this->row(entry.area.y + entry.area.h);
+            }
+
+            if (x0 == entry.x0 && y0 == entry.y0 && x1 == entry.x1 && y1 == entry.y1) { return; }
+
+            // Leave old cells
+            for (long y = entry.y0; y <= entry.y1; y++) {
+                for (long x = entry.x0; x <= entry.x1; x++) {
+
+                    std::vector<Element*>& cell = cells[y * columns + x];
+
+                    auto it = std::find(cell.begin(), cell.end(), element);
+                    if (it != cell.end()) { *it = cell.back(); cell.pop_back(); }
+                }
+            }
+
+            // Join new ones
+            for (long y = y0; y <= y1; y++) {
+                for (long x = x0; x <= x1; x++) {
+                    cells[y * columns + x].push_back(element);
+                }
+            }
+
+            entry.x0 = x0; entry.y0 = y0;
+            entry.x1 = x1; entry.y1 = y1;
+        }
+
+        // Drop deleted elements from every cell (entries stay as they were, as indices are stale
+        // until the grid is rebuilt)
+        void forget(std::vector<Element*>& gone) {
+
+            for (std::vector<Element*>& cell : cells) {
+                std::erase_if(cell, [&](Element* element) {
+                    return std::find(gone.begin(), gone.end(), element) != gone.end();
+                });
+            }
+        }
+
+        long column(float x) {
+            return std::clamp(long(std::floor((x - bounds.x) / cellSize)), 0L, columns - 1);
+        }
+
+        long row(float y) {
+            return std::clamp(long(std::floor((y - bounds.y) / cellSize)), 0L, rows - 1);
+        }
+
+        // Querying
+        //--------------------------------------------------
+
+        // Elements containing a position (in no particular order)
+        void query(Pos& pos, std::vector<Element*>& hits) {
+
+            hits.clear();
+
+            if (cells.empty() || !bounds.contains(pos)) { return; }
+
+            for (Element* element : cells[this->row(pos.y) * columns + this->column(pos.x)]) {
+                if (entries[element->topDownIndex].area.contains(pos) && element->contains(pos)) {
+                    hits.push_back(element);
+                }
+            }
+        }
+    };
+}
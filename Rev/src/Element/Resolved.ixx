@@ -1,6 +1,7 @@
 module;
 
 #include <bit>
+#include <cstdint>
 #include <algorithm>
 
 export module Rev.Element.Resolved;
@@ -24,6 +25,16 @@ namespace Rev::Element {
         bool growable = false;
         bool fit = true;
 
+        // Compare bitwise, since -0.0f (unset) must differ from 0.0f
+        bool same(const ResolvedDim& other) const {
+            return (
+                std::bit_cast<uint32_t>(val) == std::bit_cast<uint32_t>(other.val) &&
+                std::bit_cast<uint32_t>(min) == std::bit_cast<uint32_t>(other.min) &&
+                std::bit_cast<uint32_t>(max) == std::bit_cast<uint32_t>(other.max) &&
+                growable == other.growable && fit == other.fit
+            );
+        }
+
         void setAbs(Dist& newVal, Dist& newMin, Dist& newMax) {
 
             // Set new val/min/max if type is absolute
@@ -136,6 +147,10 @@ namespace Rev::Element {
 
         ResolvedDim w, h;
 
+        bool same(const ResolvedSize& other) const {
+            return w.same(other.w) && h.same(other.h);
+        }
+
         void setAbs(Size& size) {
             w.setAbs(size.width, size.minWidth, size.maxWidth);
             h.setAbs(size.height, size.minHeight, size.maxHeight);
@@ -187,6 +202,10 @@ namespace Rev::Element {
 
         ResolvedDim l, r, t, b;
 
+        bool same(const ResolvedLrtb& other) const {
+            return l.same(other.l) && r.same(other.r) && t.same(other.t) && b.same(other.b);
+        }
+
         void setAbs(LrtbStyle& lrtb) {
 
             l.setAbs(lrtb.left, lrtb.minLeft, lrtb.maxLeft);
@@ -275,6 +294,10 @@ namespace Rev::Element {
         ResolvedLrtb pad;
         ResolvedLrtb pos;
 
+        bool same(const Resolved& other) const {
+            return size.same(other.size) && mar.same(other.mar) && pad.same(other.pad) && pos.same(other.pos);
+        }
+
         // Clamp all dims
         void clamp() {
             size.clamp();
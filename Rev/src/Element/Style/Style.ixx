@@ -9,6 +9,8 @@ export module Rev.Element.Style;
 
 import Rev.Core.Resource;
 
+import Rev.Element.Animator;
+
 export namespace Rev::Element {
 
     // Returns if value is set
@@ -24,53 +26,6 @@ export namespace Rev::Element {
         return std::bit_cast<std::uint32_t>(a) != std::bit_cast<std::uint32_t>(b);
     }
 
-    // Transitions
-    //--------------------------------------------------
-    
-    struct Transition {
-
-        // Target
-        float* subject;
-
-        // Interp
-        float startVal, endVal;
-        uint64_t startTime, endTime;
-
-        static float ease(float& a, float& b, float& t) {
-
-            float sqr = t * t;
-            float t_adj = sqr / (2.0f * (sqr - t) + 1.0f);
-
-            return std::lerp(a, b, t_adj);
-        }
-
-        static void createNew(float& newVal, float& oldVal, std::vector<Transition>& transitions, uint64_t& time, int& ms) {
-
-            // Search for redundant transitions
-            for (Transition& transition : transitions) {
-
-                if (transition.subject == &newVal) {
-
-                    if (transition.endVal != newVal) {                        
-                        transition.startVal = oldVal;
-                        transition.endVal = newVal;
-                        transition.startTime = time;
-                        transition.endTime = time + ms;
-                    }
-
-                    return;
-                }
-            }
-
-            // Create new transition
-            transitions.push_back({
-                &newVal,
-                oldVal, newVal,
-                time, time + ms
-            });
-        }
-    };
-
     // Distance
     //--------------------------------------------------
 
@@ -87,12 +42,12 @@ export namespace Rev::Element {
 
         int transition = -1;
 
-        inline void animate(Dist& old, std::vector<Transition>& transitions, uint64_t& time, int& ms) {
+        inline void animate(Dist& old, Animator& animator, int& ms) {
 
             int transitionLength = transition > 0 ? transition : ms;
             if (transitionLength < 1) { return; }
 
-            if (val != old.val) { Transition::createNew(val, old.val, transitions, time, transitionLength); }
+            animator.track(val, old.val, transitionLength);
         }
 
         inline void apply(Dist& other) {
@@ -106,6 +61,11 @@ export namespace Rev::Element {
         explicit operator bool() {
             return type != None;
         }
+
+        // Same type and (bitwise) value
+        bool same(Dist& other) {
+            return type == other.type && equ(val, other.val);
+        }
     };
 
     // Pixel distance
@@ -180,15 +140,15 @@ export namespace Rev::Element {
             if (other) { *this = other; }
         }
 
-        void animate(Color& old, std::vector<Transition>& transitions, uint64_t& time, int& ms) {
+        void animate(Color& old, Animator& animator, int& ms) {
 
             int transitionLength = transition > 1 ? transition : ms;
             if (transitionLength < 1) { return; }
             
-            if (r != old.r) { Transition::createNew(r, old.r, transitions, time, transitionLength); }
-            if (g != old.g) { Transition::createNew(g, old.g, transitions, time, transitionLength); }
-            if (b != old.b) { Transition::createNew(b, old.b, transitions, time, transitionLength); }
-            if (a != old.a) { Transition::createNew(a, old.a, transitions, time, transitionLength); }
+            animator.track(r, old.r, transitionLength);
+            animator.track(g, old.g, transitionLength);
+            animator.track(b, old.b, transitionLength);
+            animator.track(a, old.a, transitionLength);
         }
 
         explicit operator bool() {
@@ -229,21 +189,29 @@ export namespace Rev::Element {
             if (size.transition > 0) { transition = size.transition; }
         }
 
-        inline void animate(Size& old, std::vector<Transition>& transitions, uint64_t& time, int& ms) {
+        bool same(Size& other) {
+            return (
+                width.same(other.width) && height.same(other.height) &&
+                minWidth.same(other.minWidth) && maxWidth.same(other.maxWidth) &&
+                minHeight.same(other.minHeight) && maxHeight.same(other.maxHeight)
+            );
+        }
+
+        inline void animate(Size& old, Animator& animator, int& ms) {
 
             int transitionLength = transition > 1 ? transition : ms;
 
             // Animate nominal width/height
-            width.animate(old.width, transitions, time, transitionLength);
-            height.animate(old.height, transitions, time, transitionLength);
+            width.animate(old.width, animator, transitionLength);
+            height.animate(old.height, animator, transitionLength);
 
             // Animate min/max width
-            minWidth.animate(old.minWidth, transitions, time, transitionLength);
-            maxWidth.animate(old.maxWidth, transitions, time, transitionLength);
+            minWidth.animate(old.minWidth, animator, transitionLength);
+            maxWidth.animate(old.maxWidth, animator, transitionLength);
 
             // Animate min/max height
-            minHeight.animate(old.minHeight, transitions, time, transitionLength);
-            maxHeight.animate(old.maxHeight, transitions, time, transitionLength);
+            minHeight.animate(old.minHeight, animator, transitionLength);
+            maxHeight.animate(old.maxHeight, animator, transitionLength);
         }
     };
 
@@ -276,27 +244,35 @@ export namespace Rev::Element {
             if (lrtb.transition > 0) { transition = lrtb.transition; }
         }
 
-        inline void animate(LrtbStyle& old, std::vector<Transition>& transitions, uint64_t& time, int& ms) {
+        bool same(LrtbStyle& other) {
+            return (
+                left.same(other.left) && right.same(other.right) && top.same(other.top) && bottom.same(other.bottom) &&
+                minLeft.same(other.minLeft) && minRight.same(other.minRight) && minTop.same(other.minTop) && minBottom.same(other.minBottom) &&
+                maxLeft.same(other.maxLeft) && maxRight.same(other.maxRight) && maxTop.same(other.maxTop) && maxBottom.same(other.maxBottom)
+            );
+        }
+
+        inline void animate(LrtbStyle& old, Animator& animator, int& ms) {
 
             int transitionLength = transition > 1 ? transition : ms;
 
             // Animating the margins/paddings
-            left.animate(old.left, transitions, time, transitionLength);
-            right.animate(old.right, transitions, time, transitionLength);
-            top.animate(old.top, transitions, time, transitionLength);
-            bottom.animate(old.bottom, transitions, time, transitionLength);
+            left.animate(old.left, animator, transitionLength);
+            right.animate(old.right, animator, transitionLength);
+            top.animate(old.top, animator, transitionLength);
+            bottom.animate(old.bottom, animator, transitionLength);
         
             // Animating the minimum values
-            minLeft.animate(old.minLeft, transitions, time, transitionLength);
-            minRight.animate(old.minRight, transitions, time, transitionLength);
-            minTop.animate(old.minTop, transitions, time, transitionLength);
-            minBottom.animate(old.minBottom, transitions, time, transitionLength);
+            minLeft.animate(old.minLeft, animator, transitionLength);
+            minRight.animate(old.minRight, animator, transitionLength);
+            minTop.animate(old.minTop, animator, transitionLength);
+            minBottom.animate(old.minBottom, animator, transitionLength);
         
             // Animating the maximum values
-            maxLeft.animate(old.maxLeft, transitions, time, transitionLength);
-            maxRight.animate(old.maxRight, transitions, time, transitionLength);
-            maxTop.animate(old.maxTop, transitions, time, transitionLength);
-            maxBottom.animate(old.maxBottom, transitions, time, transitionLength);
+            maxLeft.animate(old.maxLeft, animator, transitionLength);
+            maxRight.animate(old.maxRight, animator, transitionLength);
+            maxTop.animate(old.maxTop, animator, transitionLength);
+            maxBottom.animate(old.maxBottom, animator, transitionLength);
         }
     };
 
@@ -334,6 +310,13 @@ export namespace Rev::Element {
             if (other.vertical != Align::Unset) { vertical = other.vertical; }
             if (other.breakWrap != Break::Unset) { breakWrap = other.breakWrap; }
         }
+
+        bool same(Alignment& other) {
+            return (
+                direction == other.direction && horizontal == other.horizontal &&
+                vertical == other.vertical && breakWrap == other.breakWrap
+            );
+        }
     };
 
     // Background and shadow
@@ -350,11 +333,11 @@ export namespace Rev::Element {
             if (background.transition > 0) { transition = background.transition; }
         }
 
-        inline void animate(Background& old, std::vector<Transition>& transitions, uint64_t& time, int& ms) {
+        inline void animate(Background& old, Animator& animator, int& ms) {
             
             int transitionLength = transition > 0 ? transition : ms;
 
-            color.animate(old.color, transitions, time, transitionLength);
+            color.animate(old.color, animator, transitionLength);
         }
     };
 
@@ -389,13 +372,13 @@ export namespace Rev::Element {
                 if (corner.width) { radius = corner.width; }
             }
 
-            inline void animate(Corner& old, std::vector<Transition>& transitions, uint64_t& time, int& ms) {
+            inline void animate(Corner& old, Animator& animator, int& ms) {
 
                 int transitionLength = transition > 0 ? transition : ms;
 
-                color.animate(old.color, transitions, time, transitionLength);
-                radius.animate(old.radius, transitions, time, transitionLength);
-                width.animate(old.radius, transitions, time, transitionLength);
+                color.animate(old.color, animator, transitionLength);
+                radius.animate(old.radius, animator, transitionLength);
+                width.animate(old.width, animator, transitionLength);
             }
         };
 
@@ -422,18 +405,18 @@ export namespace Rev::Element {
             bl.apply(border.bl); br.apply(border.br);
         }
 
-        inline void animate(Border& old, std::vector<Transition>& transitions, uint64_t& time, int& ms) {
+        inline void animate(Border& old, Animator& animator, int& ms) {
             
             int transitionLength = transition > 0 ? transition : ms;
 
-            color.animate(old.color, transitions, time, transitionLength);
-            radius.animate(old.radius, transitions, time, transitionLength);
-            width.animate(old.radius, transitions, time, transitionLength);
+            color.animate(old.color, animator, transitionLength);
+            radius.animate(old.radius, animator, transitionLength);
+            width.animate(old.width, animator, transitionLength);
 
-            tl.animate(old.tl, transitions, time, transitionLength);
-            tr.animate(old.tr, transitions, time, transitionLength);
-            bl.animate(old.bl, transitions, time, transitionLength);
-            br.animate(old.br, transitions, time, transitionLength);
+            tl.animate(old.tl, animator, transitionLength);
+            tr.animate(old.tr, animator, transitionLength);
+            bl.animate(old.bl, animator, transitionLength);
+            br.animate(old.br, animator, transitionLength);
         }
     };
 
@@ -459,11 +442,11 @@ export namespace Rev::Element {
             spacing.apply(other.spacing);
         }
 
-        inline void animate(TextStyle& old, std::vector<Transition>& transitions, uint64_t& time, int& ms) {
+        inline void animate(TextStyle& old, Animator& animator, int& ms) {
 
             int transitionLength = transition > 0 ? transition : ms;
 
-            color.animate(old.color, transitions, time, transitionLength);
+            color.animate(old.color, animator, transitionLength);
         }
     };
 
@@ -535,13 +518,30 @@ export namespace Rev::Element {
             }
         }
 
-        void animate(Style& old, std::vector<Transition>& transitions, uint64_t& time) {
-            size.animate(old.size, transitions, time, transition);
-            background.animate(old.background, transitions, time, transition);
-            border.animate(old.border, transitions, time, transition);
-            margin.animate(old.margin, transitions, time, transition);
-            padding.animate(old.padding, transitions, time, transition);
-            text.animate(old.text, transitions, time, transition);
+        // Whether layout would come out the same under both styles (anything else is paint-only)
+        bool sameLayout(Style& other) {
+            return (
+                absolute == other.absolute &&
+                size.same(other.size) &&
+                position.same(other.position) &&
+                margin.same(other.margin) &&
+                padding.same(other.padding) &&
+                alignment.same(other.alignment)
+            );
+        }
+
+        // Animate values which changed since the old style (layout-affecting ones, then paint-only ones)
+        void animate(Style& old, Animator& animator) {
+
+            animator.layout = true;
+            size.animate(old.size, animator, transition);
+            margin.animate(old.margin, animator, transition);
+            padding.animate(old.padding, animator, transition);
+
+            animator.layout = false;
+            background.animate(old.background, animator, transition);
+            border.animate(old.border, animator, transition);
+            text.animate(old.text, animator, transition);
         }
     };
 
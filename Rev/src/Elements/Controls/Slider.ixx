@@ -161,7 +161,13 @@ export namespace Rev::Element {
         void computeStyle(Event& e) override {
 
             float pctVal = (data.val - data.min) / (data.max - data.min);
-            track->style->padding.left = Pct(100.0f * pctVal);
+            Dist padLeft = Pct(100.0f * pctVal);
+
+            // Track must recompute its own style
+            if (!track->style->padding.left.same(padLeft)) {
+                track->style->padding.left = padLeft;
+                track->refresh(e);
+            }
         
             Box::computeStyle(e);
         }
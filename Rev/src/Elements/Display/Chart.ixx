@@ -14,6 +14,7 @@ import Rev.Core.Vertex;
 import Rev.Core.Rect;
 import Rev.Core.View;
 import Rev.Core.Transform;
+import Rev.Core.Series;
 
 import Rev.Element;
 import Rev.Element.Event;
@@ -46,8 +47,8 @@ export namespace Rev::Element {
         Transform chartToScreen;
         Transform screenToChart;
 
-        // Points in chart-space, and screen-space
-        std::vector<Vertex> points;
+        // Samples in chart-space (stream in through append), and decimated points in screen-space
+        Series series;
         std::vector<Vertex> screenPoints;
         std::vector<Vertex> screenBottom;
         std::vector<Vertex> gridPoints;
@@ -74,6 +75,15 @@ export namespace Rev::Element {
             line = new Lines(canvas, { &screenPoints });
         }
         
+        // Samples
+        //--------------------------------------------------
+
+        // Stream in a sample (redrawn with the next frame)
+        void append(Pos sample) {
+            series.append(sample);
+            refresh(*shared->event);
+        }
+
         // Adjusting view
         //--------------------------------------------------
 
@@ -331,15 +341,16 @@ export namespace Rev::Element {
             line->color = { 1, 0, 0, 1 };
             fill->color = { 1, 0, 0, 0.5 };
 
-            screenPoints.resize(points.size());
-            screenBottom.resize(points.size());
+            // Only the visible range, at about two points per pixel column
+            size_t columns = size_t(std::ceil(rect.w * shared->canvas->details.scale));
+            series.decimate(view.l, view.r, columns, screenPoints);
+
+            screenBottom.resize(screenPoints.size());
             
-            for (size_t i = 0; i < points.size(); i++) {
-                screenBottom[i] = { points[i].x, 0.5, { 1, 0, 0, 0.1 } };
+            for (size_t i = 0; i < screenPoints.size(); i++) {
+                screenBottom[i] = { screenPoints[i].x, 0.5, { 1, 0, 0, 0.1 } };
             }
 
-            screenPoints = points;
-
             for (Vertex& point : screenPoints) { point = chartToScreen * point; }
             for (Vertex& point : screenBottom) { point = chartToScreen * point; }
 
@@ -23,7 +23,7 @@ export namespace Rev::Element {
             measure = true;
 
             text = new Text(shared->canvas);
-            text->content = content;
+            text->setContent(content);
         }
 
         // Destroy
@@ -32,8 +32,8 @@ export namespace Rev::Element {
             delete text;
         }
 
-        // Set content as a value
-        void addContent(float val, int digits = 4) {
+        // Format a value to a number of significant digits
+        static std::string format(float val, int digits = 4) {
 
             char buffer[64];
             std::snprintf(buffer, sizeof(buffer), "%.*f", 10, val);
@@ -49,21 +49,29 @@ export namespace Rev::Element {
                 if (count > digits) { c = '\0'; break; }
             }
 
-            text->content += buffer;
+            return buffer;
+        }
+
+        // Set content as a value
+        void addContent(float val, int digits = 4) {
+            text->addContent(format(val, digits));
+            refresh(*shared->event);
         }
 
         // Set content as a string
         void addContent(std::string content) {
-            text->content += content;
+            text->addContent(content);
+            refresh(*shared->event);
         }
 
         void setContent(std::string content) {
-            text->content = content;
+            text->setContent(content);
+            refresh(*shared->event);
         }
 
         void setContent(float val, int digits = 4) {
-            text->content = "";
-            addContent(val, digits);
+            text->setContent(format(val, digits));
+            refresh(*shared->event);
         }
 
         void computeStyle(Event& e) override {
@@ -72,15 +80,15 @@ export namespace Rev::Element {
             
             text->fontSize = computed.style.text.size.val;
             if (!text->fontSize) { text->fontSize = 12.0f; }
+        }
 
-            Text::MinMax minMax = text->measure();
-            text->layout(99999999.0f);
+        // Wrap to the width we may take (laying out again only if it changed), and take the text's size
+        void measureDims(float maxWidth, float maxHeight) override {
 
-            style->size = {
-                .width = Px(text->dims.width), .height = Px(text->dims.height)
-            };
+            Text::Dims dims = text->layout(maxWidth);
 
-            Box::computeStyle(e);
+            res.size.w.val = res.size.w.min = res.size.w.max = dims.width;
+            res.size.h.val = res.size.h.min = res.size.h.max = dims.height;
         }
 
         void computePrimitives(Event& e) override {
@@ -0,0 +1,124 @@
+module;
+
+#include <cstddef>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+export module Rev.Graphics.Batch;
+
+import Rev.Graphics.Pipeline;
+import Rev.Graphics.VertexBuffer;
+import Rev.Graphics.Texture;
+import Rev.Graphics.RenderThread;
+
+export namespace Rev::Graphics {
+
+    // An arena of records (instances, or vertices) for a single pipeline. Primitives append
+    // to it while drawing, and the canvas draws each consecutive run of records in one call.
+    // Each frame in flight has its own region of the arena, so one can be written while
+    // another is still being drawn.
+    struct Batch {
+
+        struct Params {
+
+            Pipeline::Topology topology = Pipeline::Topology::TriangleList;
+
+            bool instanced = true;      // Records are instances (otherwise vertices)
+            size_t verticesPer = 6;     // Vertices drawn per instance
+            size_t reserve = 256;       // Initial capacity (records)
+            size_t window = 1;          // Records each instance reads (its own and those after)
+
+            std::vector<size_t> attribs;
+        };
+
+        Params params;
+
+        void* context = nullptr;
+        Pipeline* pipeline = nullptr;
+        Texture* texture = nullptr;
+        VertexBuffer* arena = nullptr;
+
+        // Record size in bytes
+        size_t stride = 0;
+
+        // Records appended / drawn during the current frame (into its slot's region)
+        size_t frame = 0, slot = 0;
+        size_t used = 0, drawn = 0;
+
+        // Create
+        Batch(void* context, Pipeline* pipeline, Params params) {
+
+            this->params = params;
+            this->context = context;
+            this->pipeline = pipeline;
+
+            stride = sizeof(float) * std::accumulate(params.attribs.begin(), params.attribs.end(), size_t(0));
+
+            arena = this->createArena(params.reserve);
+        }
+
+        // Destroy
+        ~Batch() {
+            delete arena;
+        }
+
+        VertexBuffer* createArena(size_t num) {
+
+            return new VertexBuffer(context, {
+                .divisor = params.instanced ? size_t(1) : size_t(0),
+                .num = num,
+                .window = params.window,
+                .regions = RenderThread::slots,
+                .attribs = params.attribs
+            });
+        }
+
+        // Records per region
+        size_t capacity() {
+            return arena->params.num;
+        }
+
+        // Index of the first record of the current region
+        size_t base() {
+            return slot * capacity();
+        }
+
+        bool fits(size_t num) {
+            return used + num <= capacity();
+        }
+
+        // Instances drawing a run of records (windows overlap, so they must all fit in the run)
+        size_t instances(size_t count) {
+            return (count >= params.window) ? count - (params.window - 1) : 0;
+        }
+
+        // Start over in a slot's region (arena memory is reused between frames)
+        void reset(size_t newFrame, size_t newSlot) {
+            frame = newFrame;
+            slot = newSlot;
+            used = drawn = 0;
+        }
+
+        // Reserve space for records, returning where to write them
+        void* append(size_t num) {
+
+            void* records = static_cast<char*>(arena->region(slot)) + used * stride;
+            used += num;
+
+            return records;
+        }
+
+        // Replace arena with a larger one (pending records must be drawn first). The old one
+        // is returned, to be deleted once nothing in flight draws from it.
+        VertexBuffer* grow(size_t num) {
+
+            VertexBuffer* old = arena;
+
+            arena = this->createArena(std::max(2 * capacity(), num));
+            used = drawn = 0;
+
+            return old;
+        }
+    };
+};
@@ -0,0 +1,538 @@
+module;
+
+#include <cmath>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+export module Rev.Graphics.Canvas;
+
+import Rev.NativeWindow;
+import Rev.Graphics.Context;
+import Rev.Graphics.FrameBuffer;
+import Rev.Graphics.Pipeline;
+import Rev.Graphics.UniformBuffer;
+import Rev.Graphics.VertexBuffer;
+import Rev.Graphics.Texture;
+import Rev.Graphics.Batch;
+import Rev.Graphics.Rasterizer;
+import Rev.Graphics.RenderThread;
+
+export namespace Rev::Graphics {
+
+    // A canvas without a GPU: draws (and the buffer uploads they imply) are recorded
+    // in memory, and optionally rasterized on the CPU into the framebuffer. As with the
+    // other canvases, a frame is recorded into a packet and submitted once it ends, in place
+    // or by a render thread (pipelined).
+    struct Canvas {
+
+        struct Flags {
+            bool resize = true;
+            bool record = true;
+            bool stencil = false;
+            bool color = false;
+            bool rasterize = false;
+        };
+
+        struct Details {
+            size_t width, height;
+            float scale = 1.0f;
+        };
+
+        // Per-frame counters
+        struct Stats {
+            size_t drawCalls = 0;
+            size_t stateBinds = 0;
+        };
+
+        // A recorded draw call
+        struct Draw {
+
+            Pipeline* pipeline = nullptr;
+            Texture* texture = nullptr;
+
+            bool instanced = false;
+            size_t first = 0, count = 0;
+
+            Rasterizer::State state;
+            std::vector<unsigned char> records;     // (When recording)
+        };
+
+        // A recorded call, to be made when the frame is submitted
+        struct Command {
+
+            enum Kind {
+                ColorWrite, StencilWrite, StencilDepth, StencilFill,
+                StencilPush, StencilPop, StencilSet,
+                BindPipeline, BindVertices, BindTexture,
+                Draw, DrawArrays
+            };
+
+            Kind kind;
+            size_t value = 0;           // Enabled, or stencil depth / value
+
+            Pipeline* pipeline = nullptr;
+            VertexBuffer* vertices = nullptr;
+            Texture* texture = nullptr;
+            Batch* batch = nullptr;     // (Its params, which don't change)
+
+            bool instanced = false;
+            size_t first = 0, count = 0;
+        };
+
+        // Everything needed to submit a frame, as it was recorded
+        struct Packet {
+
+            Details details;
+            bool resize = false;
+            bool record = true, rasterize = false;
+
+            std::vector<Command> commands;
+
+            std::vector<VertexBuffer*> buffers;     // Drawn from
+            std::vector<VertexBuffer*> retired;     // Replaced while recording (deleted once drawn)
+
+            // Released by primitives (deleted once drawn, see release)
+            std::vector<Batch*> released;
+            std::vector<Pipeline*> releasedPipelines;
+        };
+
+        // Context management
+        Context* context = nullptr;
+        NativeWindow* window = nullptr;
+        UniformBuffer* transform = nullptr;
+        FrameBuffer* frameBuffer = nullptr;
+        Rasterizer* rasterizer = nullptr;
+
+        // Configurable details
+        Details details;
+        Flags flags;
+
+        // Batching
+        Stats stats;
+        size_t frame = 0;
+        Batch* pending = nullptr;
+
+        // Frames in flight, and the slot being recorded
+        RenderThread renderThread;
+        std::vector<Packet> packets;
+        size_t slot = 0;
+
+        // Guards what's released into packets (which may be in flight meanwhile)
+        std::mutex releasing;
+
+        // Currently bound state (as recorded, to skip redundant binds)
+        Pipeline* boundPipeline = nullptr;
+        VertexBuffer* boundVertices = nullptr;
+
+        // Draws of the last submitted frame
+        std::vector<Draw> draws;
+
+        // Create
+        Canvas(NativeWindow* window = nullptr, bool pipelined = false) {
+
+            this->window = window;
+
+            context = new Context();
+            transform = new UniformBuffer(context, sizeof(glm::mat4), RenderThread::slots);
+            frameBuffer = new FrameBuffer(context, { .width = 1, .height = 1 });
+            rasterizer = new Rasterizer(frameBuffer);
+
+            packets.resize(RenderThread::slots);
+
+            renderThread.submit = [this](size_t slot) { this->submit(slot); };
+            renderThread.retire = [this](size_t slot) { this->retire(slot); };
+            renderThread.start(pipelined, []() {});
+        }
+
+        // Destroy
+        ~Canvas() {
+
+            renderThread.stop([this]() {
+                for (Packet& packet : packets) { this->deleteReleased(packet); }
+            });
+
+            delete rasterizer;
+            delete transform;
+            delete frameBuffer;
+            delete context;
+        }
+
+        // Frame setup / blitting
+        //--------------------------------------------------
+
+        void beginFrame() {
+
+            if (!window) { return; }
+
+            // New frame, batches start over
+            frame += 1;
+            stats = Stats();
+            pending = nullptr;
+            boundPipeline = nullptr;
+            boundVertices = nullptr;
+
+            // Record into the next slot, once the frame it last held is drawn
+            slot = renderThread.acquire();
+            Packet& packet = packets[slot];
+
+            context->clear();
+            context->record = flags.record;
+
+            // If canvas needs to adjust size to window
+            if (flags.resize) {
+
+                details.width = window->size.w;
+                details.height = window->size.h;
+                details.scale = window->scale;
+
+                packet.resize = true;
+                flags.resize = false;
+            }
+
+            packet.details = details;
+            packet.record = flags.record;
+            packet.rasterize = flags.rasterize;
+
+            glm::mat4 projection = glm::ortho(
+                0.0f, static_cast<float>(details.width) / details.scale - 0.5f,     // Left / right
+                static_cast<float>(details.height) / details.scale - 0.5f, 0.0f,    // Bottom / top
+                -1.0f, 1.0f                                                         // Near / far
+            );
+
+            transform->set(&projection, slot);
+        }
+
+        void endFrame() {
+
+            this->flush();
+
+            renderThread.push(slot);
+
+            // (Rasterizing reads textures, which the next frame may change while recording)
+            if (packets[slot].rasterize) { renderThread.finish(); }
+        }
+
+        // Wait until no frame in flight draws with anything (before destroying what they might)
+        void finish() {
+            renderThread.finish();
+        }
+
+        // Delete a batch (or pipeline) once no frame in flight draws with it, without waiting for
+        // them. It goes with the slot last recorded into, when that is retired (frames retire in
+        // order, so earlier ones are done by then).
+        void release(Batch* batch) {
+            std::lock_guard<std::mutex> lock(releasing);
+            packets[slot].released.push_back(batch);
+        }
+
+        void release(Pipeline* pipeline) {
+            std::lock_guard<std::mutex> lock(releasing);
+            packets[slot].releasedPipelines.push_back(pipeline);
+        }
+
+        // Stencil management
+        //--------------------------------------------------
+
+        // Enable / disable writing to color buffer
+        void colorWrite(bool enable) {
+
+            // Avoid redundant state changes
+            if (enable == flags.color) { return; }
+            else { flags.color = enable; }
+
+            this->flush();
+            this->record({ .kind = Command::ColorWrite, .value = enable });
+        }
+
+        // Enable / disable writing to stencil buffer
+        void stencilWrite(bool enable) {
+
+            // Avoid redundant state changes
+            if (enable == flags.stencil ) { return; }
+            else { flags.stencil = enable; }
+
+            this->flush();
+            this->record({ .kind = Command::StencilWrite, .value = enable });
+        }
+
+        // Set stencil depth
+        void stencilDepth(size_t value) {
+            this->flush();
+            this->record({ .kind = Command::StencilDepth, .value = value });
+        }
+
+        // Set to all zeroes
+        void stencilClear() {
+            this->stencilFill(0);
+        }
+
+        // Fill stencil buffer with uniform value(s)
+        void stencilFill(size_t value) {
+            this->flush();
+            this->record({ .kind = Command::StencilFill, .value = value });
+        }
+
+        // Pushing to stencil (increasing depth where test passes)
+        void stencilPush(size_t depth) {
+            this->flush();
+            this->record({ .kind = Command::StencilPush, .value = depth });
+        }
+
+        // Popping from stencil (decreasing depth where test passes)
+        void stencilPop(size_t depth) {
+            this->flush();
+            this->record({ .kind = Command::StencilPop, .value = depth });
+        }
+
+        // Setting stencil (set depth where test passes)
+        void stencilSet(size_t depth) {
+            this->flush();
+            this->record({ .kind = Command::StencilSet, .value = depth });
+        }
+
+        // Batching
+        //--------------------------------------------------
+
+        // Get space for records in a batch. Records accumulate until the batch
+        // changes or stencil state does, then are drawn with one call.
+        void* append(Batch* batch, size_t num) {
+
+            if (batch->frame != frame) { batch->reset(frame, slot); }
+
+            // A different batch ends the pending run
+            if (batch != pending) {
+                this->flush();
+                pending = batch;
+            }
+
+            // Out of room, draw what we have before growing (the old arena goes with the frame)
+            if (!batch->fits(num)) {
+                this->flush();
+                packets[slot].retired.push_back(batch->grow(num));
+                pending = batch;
+                boundVertices = nullptr;
+            }
+
+            return batch->append(num);
+        }
+
+        // Draw the pending run
+        void flush() {
+
+            if (!pending) { return; }
+
+            Batch& batch = *pending;
+            pending = nullptr;
+
+            size_t count = batch.used - batch.drawn;
+            if (!count) { return; }
+
+            this->bind(batch.pipeline);
+            this->bind(batch.arena);
+
+            if (batch.texture) {
+                this->record({ .kind = Command::BindTexture, .texture = batch.texture });
+                stats.stateBinds += 1;
+            }
+
+            upload(context, Context::Upload::Vertices, count * batch.stride);
+
+            this->record({
+                .kind = Command::Draw,
+                .vertices = batch.arena,
+                .texture = batch.texture,
+                .batch = &batch,
+                .instanced = batch.params.instanced,
+                .first = batch.base() + batch.drawn, .count = count
+            });
+
+            batch.drawn = batch.used;
+            stats.drawCalls += 1;
+        }
+
+        void bind(Pipeline* pipeline) {
+
+            if (pipeline == boundPipeline) { return; }
+            else { boundPipeline = pipeline; }
+
+            this->record({ .kind = Command::BindPipeline, .pipeline = pipeline });
+            stats.stateBinds += 1;
+        }
+
+        void bind(VertexBuffer* vertices) {
+
+            if (vertices == boundVertices) { return; }
+            else { boundVertices = vertices; }
+
+            this->record({ .kind = Command::BindVertices, .vertices = vertices });
+            stats.stateBinds += 1;
+
+            std::vector<VertexBuffer*>& buffers = packets[slot].buffers;
+            if (std::find(buffers.begin(), buffers.end(), vertices) == buffers.end()) { buffers.push_back(vertices); }
+        }
+
+        void record(Command command) {
+            packets[slot].commands.push_back(command);
+        }
+
+        // Submitting (where frames are submitted, maybe the render thread)
+        //--------------------------------------------------
+
+        void submit(size_t slot) {
+
+            Packet& packet = packets[slot];
+
+            if (packet.resize) {
+                frameBuffer->resize(packet.details.width, packet.details.height);
+                packet.resize = false;
+            }
+
+            draws.clear();
+
+            rasterizer->scale = packet.details.scale;
+            rasterizer->state = Rasterizer::State();
+
+            // Clear before drawing
+            if (packet.rasterize) {
+                frameBuffer->clearColor({ 1.0f, 1.0f, 1.0f, 1.0f });
+                frameBuffer->clearStencil(0);
+            }
+
+            for (Command& command : packet.commands) {
+                this->execute(command, packet);
+            }
+
+            for (VertexBuffer* buffer : packet.buffers) { buffer->fence(slot); }
+            transform->fence(slot);
+
+            if (window) { window->swapBuffers(); }
+        }
+
+        // Free what a slot's frame replaced
+        void retire(size_t slot) {
+
+            Packet& packet = packets[slot];
+
+            for (VertexBuffer* buffer : packet.buffers) { buffer->wait(slot); }
+            transform->wait(slot);
+
+            for (VertexBuffer* buffer : packet.retired) { delete buffer; }
+
+            packet.commands.clear();
+            packet.buffers.clear();
+            packet.retired.clear();
+
+            this->deleteReleased(packet);
+        }
+
+        void deleteReleased(Packet& packet) {
+
+            std::lock_guard<std::mutex> lock(releasing);
+
+            for (Batch* batch : packet.released) { delete batch; }
+            for (Pipeline* pipeline : packet.releasedPipelines) { delete pipeline; }
+
+            packet.released.clear();
+            packet.releasedPipelines.clear();
+        }
+
+        void execute(Command& command, Packet& packet) {
+
+            Rasterizer::State& state = rasterizer->state;
+
+            switch (command.kind) {
+
+                case (Command::ColorWrite): { state.colorWrite = command.value; break; }
+                case (Command::StencilWrite): { state.stencilWrite = command.value; break; }
+                case (Command::StencilDepth): { state.ref = uint8_t(command.value); break; }
+
+                // (Clearing respects the write mask)
+                case (Command::StencilFill): {
+                    if (packet.rasterize && state.stencilWrite) { frameBuffer->clearStencil(uint8_t(command.value)); }
+                    break;
+                }
+
+                case (Command::StencilPush): { state.ref = uint8_t(command.value); state.op = Rasterizer::State::Incr; break; }
+                case (Command::StencilPop): { state.ref = uint8_t(command.value); state.op = Rasterizer::State::Decr; break; }
+                case (Command::StencilSet): { state.ref = uint8_t(command.value); state.op = Rasterizer::State::Replace; break; }
+
+                case (Command::BindPipeline): { command.pipeline->bind(); break; }
+                case (Command::BindVertices): { command.vertices->bind(); break; }
+                case (Command::BindTexture): { command.texture->bind(0); break; }
+
+                case (Command::Draw): {
+
+                    Batch& batch = *command.batch;
+                    const unsigned char* records = static_cast<unsigned char*>(command.vertices->data) + command.first * batch.stride;
+
+                    if (packet.record) {
+                        this->recordDraw({
+                            .pipeline = batch.pipeline,
+                            .texture = command.texture,
+                            .instanced = command.instanced,
+                            .first = command.first, .count = command.count,
+                            .state = state
+                        }, records, command.count * batch.stride);
+                    }
+
+                    if (packet.rasterize) { this->rasterize(batch, command.texture, records, command.count); }
+
+                    break;
+                }
+
+                case (Command::DrawArrays): {
+                    if (packet.record) { this->recordDraw({ .instanced = command.instanced, .first = command.first, .count = command.count, .state = state }); }
+                    break;
+                }
+            }
+        }
+
+        // Recording / rasterizing
+        //--------------------------------------------------
+
+        void recordDraw(Draw draw, const unsigned char* records = nullptr, size_t size = 0) {
+
+            if (records) { draw.records.assign(records, records + size); }
+            draws.push_back(std::move(draw));
+        }
+
+        // What to draw follows from the record layout: instances of rect, color, corners
+        // (rectangles), instances of rect, atlas rect, color (glyphs), windows of polyline
+        // points (lines), or colored vertices
+        void rasterize(Batch& batch, Texture* texture, const unsigned char* records, size_t count) {
+
+            const float* data = reinterpret_cast<const float*>(records);
+
+            if (!batch.params.instanced) { rasterizer->triangles(data, count); }
+            else if (batch.params.window > 1) { rasterizer->polylines(data, count); }
+            else if (batch.stride != 12 * sizeof(float)) { return; }
+            else if (texture) { rasterizer->glyphs(data, count, texture); }
+            else { rasterizer->rectangles(data, count); }
+        }
+
+        // Drawing functions
+        //--------------------------------------------------
+
+        // (Unbatched, callers flush() and bind() their own state first; recorded, not rasterized)
+        void drawArrays(Pipeline::Topology topology, size_t start, size_t verticesPer) {
+
+            boundPipeline = nullptr;
+            boundVertices = nullptr;
+
+            this->record({ .kind = Command::DrawArrays, .first = start, .count = verticesPer });
+            stats.drawCalls += 1;
+        }
+
+        void drawArraysInstanced(Pipeline::Topology topology, size_t start, size_t verticesPer, size_t numInstances) {
+
+            boundPipeline = nullptr;
+            boundVertices = nullptr;
+
+            this->record({ .kind = Command::DrawArrays, .instanced = true, .first = start, .count = numInstances });
+            stats.drawCalls += 1;
+        }
+    };
+};
\ No newline at end of file
@@ -0,0 +1,46 @@
+module;
+
+#include <cstddef>
+#include <vector>
+
+export module Rev.Graphics.Context;
+
+export namespace Rev::Graphics {
+
+    // There is no GPU when headless, so buffers and textures note what they would have
+    // sent to one here instead (the canvas hands this out as its context)
+    struct Context {
+
+        struct Upload {
+
+            enum Kind {
+                Vertices, Uniforms, Texture
+            };
+
+            Kind kind;
+            size_t bytes;
+        };
+
+        bool record = true;
+
+        std::vector<Upload> uploads;
+        size_t bytes = 0;
+
+        void upload(Upload::Kind kind, size_t size) {
+
+            bytes += size;
+
+            if (record) { uploads.push_back({ kind, size }); }
+        }
+
+        void clear() {
+            uploads.clear();
+            bytes = 0;
+        }
+    };
+
+    // Note an upload, if there is a context to note it in
+    void upload(void* context, Context::Upload::Kind kind, size_t size) {
+        if (context) { static_cast<Context*>(context)->upload(kind, size); }
+    }
+};
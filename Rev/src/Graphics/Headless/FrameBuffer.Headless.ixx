@@ -0,0 +1,87 @@
+module;
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+export module Rev.Graphics.FrameBuffer;
+
+export namespace Rev::Graphics {
+
+    // Color and stencil in memory, drawn to by the rasterizer (if enabled)
+    struct FrameBuffer {
+
+        void* context = nullptr;
+
+        struct Params {
+            size_t width = 0, height = 0;
+            size_t colorChannels = 4;
+        };
+
+        struct Color {
+            float r = 0, g = 0, b = 0, a = 0;
+        };
+
+        Params params;
+
+        std::vector<Color> color;
+        std::vector<uint8_t> stencil;
+
+        // Create
+        FrameBuffer(void* context, Params params) {
+
+            this->context = context;
+            this->params = params;
+
+            this->resize(params.width, params.height);
+        }
+
+        void resize(size_t width, size_t height) {
+
+            // Reject invalid size
+            if (!width || !height) {
+                throw std::runtime_error("[FrameBuffer] Invalid size");
+            }
+
+            params.width = width;
+            params.height = height;
+
+            color.assign(width * height, Color());
+            stencil.assign(width * height, 0);
+        }
+
+        void clearColor(Color value) {
+            std::fill(color.begin(), color.end(), value);
+        }
+
+        void clearStencil(uint8_t value) {
+            std::fill(stencil.begin(), stencil.end(), value);
+        }
+
+        // 8-bit RGBA rows, top to bottom (for writing out / comparing images)
+        std::vector<uint8_t> rgba8() {
+
+            std::vector<uint8_t> out(color.size() * 4);
+
+            auto byte = [](float v) {
+                return uint8_t(std::lround(std::clamp(v, 0.0f, 1.0f) * 255.0f));
+            };
+
+            for (size_t i = 0; i < color.size(); i++) {
+                out[4 * i + 0] = byte(color[i].r);
+                out[4 * i + 1] = byte(color[i].g);
+                out[4 * i + 2] = byte(color[i].b);
+                out[4 * i + 3] = byte(color[i].a);
+            }
+
+            return out;
+        }
+
+        void bind() {
+
+        }
+    };
+};
@@ -0,0 +1,62 @@
+module;
+
+#include <cstddef>
+#include <vector>
+
+export module Rev.Graphics.Pipeline;
+
+import Rev.Core.Resource;
+import Rev.Graphics.Shader;
+
+export namespace Rev::Graphics {
+
+    using namespace Rev::Core;
+
+    struct Pipeline {
+
+        enum Topology {
+            TriangleFan,
+            TriangleList
+        };
+
+        size_t users = 0;
+
+        Shader* vert = nullptr;
+        Shader* frag = nullptr;
+
+        struct Params {
+
+            bool instanced = true;
+            std::vector<float> attribs;
+
+            Resource openGlVert;
+            Resource openGlFrag;
+
+            Resource metalUniversal;
+
+            Resource vulkanVert;
+            Resource vulkanFrag;
+        };
+
+        Params params;
+
+        // Create
+        Pipeline(void* context, Params params) {
+
+            this->params = params;
+
+            vert = new Shader(params.openGlVert, Shader::Stage::Vertex);
+            frag = new Shader(params.openGlFrag, Shader::Stage::Fragment);
+        }
+
+        // Destroy
+        ~Pipeline() {
+            delete vert;
+            delete frag;
+        }
+
+        void bind() {
+
+        }
+    };
+};
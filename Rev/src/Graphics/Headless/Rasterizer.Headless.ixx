@@ -0,0 +1,240 @@
+module;
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "../Primitives/Lines/TriangulatePolyline.hpp"
+
+export module Rev.Graphics.Rasterizer;
+
+import Rev.Graphics.FrameBuffer;
+import Rev.Graphics.Texture;
+
+export namespace Rev::Graphics {
+
+    // Draws the canvas' records into a framebuffer in memory, following what the
+    // OpenGL shaders and fixed-function state do (one sample per pixel, at its center).
+    // Meant for golden image checks rather than speed.
+    struct Rasterizer {
+
+        // Stencil / color state, as the canvas sets it
+        struct State {
+
+            enum Op {
+                Keep, Incr, Decr, Replace
+            };
+
+            uint8_t ref = 0;
+            Op op = Keep;
+
+            bool stencilWrite = true;
+            bool colorWrite = true;
+        };
+
+        using Color = FrameBuffer::Color;
+
+        FrameBuffer* target = nullptr;
+        State state;
+
+        float scale = 1.0f;
+
+        // Expanded polylines
+        PolylineBatch polyline;
+        std::vector<Vec2> expanded;
+
+        // Create
+        Rasterizer(FrameBuffer* target) {
+            this->target = target;
+        }
+
+        static float smoothstep(float lo, float hi, float x) {
+            float t = std::clamp((x - lo) / (hi - lo), 0.0f, 1.0f);
+            return t * t * (3.0f - 2.0f * t);
+        }
+
+        // Pixels covered by a box in canvas units (clipped to target)
+        void span(float x, float y, float w, float h, long& x0, long& y0, long& x1, long& y1) {
+
+            x0 = std::max(0L, long(std::floor(x * scale)));
+            y0 = std::max(0L, long(std::floor(y * scale)));
+            x1 = std::min(long(target->params.width), long(std::ceil((x + w) * scale)));
+            y1 = std::min(long(target->params.height), long(std::ceil((y + h) * scale)));
+        }
+
+        // Stencil test / op, then blend (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)
+        void fragment(long px, long py, Color src) {
+
+            size_t idx = size_t(py) * target->params.width + size_t(px);
+            uint8_t& stencil = target->stencil[idx];
+
+            // GL_LEQUAL
+            if (state.ref > stencil) { return; }
+
+            if (state.stencilWrite) {
+                switch (state.op) {
+                    case (State::Incr): { if (stencil < 255) { stencil += 1; } break; }
+                    case (State::Decr): { if (stencil > 0) { stencil -= 1; } break; }
+                    case (State::Replace): { stencil = state.ref; break; }
+                    default: { break; }
+                }
+            }
+
+            if (!state.colorWrite) { return; }
+
+            Color& dst = target->color[idx];
+            float inv = 1.0f - src.a;
+
+            dst = {
+                src.r * src.a + dst.r * inv,
+                src.g * src.a + dst.g * inv,
+                src.b * src.a + dst.b * inv,
+                src.a * src.a + dst.a * inv
+            };
+        }
+
+        // Primitives
+        //--------------------------------------------------
+
+        // Rounded rectangles: { x, y, w, h }, { r, g, b, a }, { tl, tr, bl, br } per instance
+        void rectangles(const float* records, size_t count) {
+
+            for (size_t i = 0; i < count; i++) {
+
+                const float* rec = records + 12 * i;
+
+                float x = rec[0], y = rec[1], w = rec[2], h = rec[3];
+                Color color = { rec[4], rec[5], rec[6], rec[7] };
+
+                float halfW = w * 0.5f, halfH = h * 0.5f;
+                float smoothing = 0.5f / scale;
+
+                long x0, y0, x1, y1;
+                this->span(x, y, w, h, x0, y0, x1, y1);
+
+                for (long py = y0; py < y1; py++) {
+                    for (long px = x0; px < x1; px++) {
+
+                        float lx = (px + 0.5f) / scale - (x + halfW);
+                        float ly = (py + 0.5f) / scale - (y + halfH);
+
+                        // Corner for this quadrant
+                        float radius = (ly < 0) ? ((lx < 0) ? rec[8] : rec[9]) : ((lx < 0) ? rec[10] : rec[11]);
+                        radius = std::clamp(radius, 0.0f, std::min(halfW, halfH));
+
+                        // Rounded box distance
+                        float qx = std::fabs(lx) - halfW + radius;
+                        float qy = std::fabs(ly) - halfH + radius;
+                        float dist = std::hypot(std::max(qx, 0.0f), std::max(qy, 0.0f)) + std::min(std::max(qx, qy), 0.0f) - radius;
+
+                        float alpha = 1.0f - smoothstep(-smoothing, smoothing, dist);
+                        if (alpha < 0.01f) { continue; }
+
+                        this->fragment(px, py, { color.r, color.g, color.b, color.a * alpha });
+                    }
+                }
+            }
+        }
+
+        // Glyphs: { x, y, w, h }, { atlas x, y, w, h }, { r, g, b, a } per instance
+        void glyphs(const float* records, size_t count, Texture* atlas) {
+
+            if (!atlas) { return; }
+
+            for (size_t i = 0; i < count; i++) {
+
+                const float* rec = records + 12 * i;
+
+                float x = rec[0], y = rec[1], w = rec[2], h = rec[3];
+                Color color = { rec[8], rec[9], rec[10], rec[11] };
+
+                if (w <= 0 || h <= 0) { continue; }
+
+                long x0, y0, x1, y1;
+                this->span(x, y, w, h, x0, y0, x1, y1);
+
+                for (long py = y0; py < y1; py++) {
+                    for (long px = x0; px < x1; px++) {
+
+                        float tx = ((px + 0.5f) / scale - x) / w;
+                        float ty = ((py + 0.5f) / scale - y) / h;
+
+                        // Bilinear sample (GL_LINEAR)
+                        float u = rec[4] + tx * rec[6] - 0.5f;
+                        float v = rec[5] + ty * rec[7] - 0.5f;
+
+                        long ux = long(std::floor(u)), vy = long(std::floor(v));
+                        float fu = u - ux, fv = v - vy;
+
+                        float top = atlas->at(ux, vy) * (1 - fu) + atlas->at(ux + 1, vy) * fu;
+                        float bottom = atlas->at(ux, vy + 1) * (1 - fu) + atlas->at(ux + 1, vy + 1) * fu;
+                        float a = (top * (1 - fv) + bottom * fv) / 255.0f;
+
+                        // Same contrast curve as the text shader
+                        float punchy = smoothstep(0.0f, 0.9f, a + 0.05f);
+
+                        this->fragment(px, py, { color.r, color.g, color.b, punchy * color.a });
+                    }
+                }
+            }
+        }
+
+        // Triangle list: { x, y }, { r, g, b, a } per vertex
+        void triangles(const float* verts, size_t count) {
+
+            for (size_t i = 0; i + 2 < count; i += 3) {
+
+                const float* a = verts + 6 * i;
+                const float* b = a + 6;
+                const float* c = b + 6;
+
+                float ax = a[0] * scale, ay = a[1] * scale;
+                float bx = b[0] * scale, by = b[1] * scale;
+                float cx = c[0] * scale, cy = c[1] * scale;
+
+                float area = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+                if (area == 0.0f) { continue; }
+
+                float minX = std::min({ a[0], b[0], c[0] }), maxX = std::max({ a[0], b[0], c[0] });
+                float minY = std::min({ a[1], b[1], c[1] }), maxY = std::max({ a[1], b[1], c[1] });
+
+                long x0, y0, x1, y1;
+                this->span(minX, minY, maxX - minX, maxY - minY, x0, y0, x1, y1);
+
+                for (long py = y0; py < y1; py++) {
+                    for (long px = x0; px < x1; px++) {
+
+                        float sx = px + 0.5f, sy = py + 0.5f;
+
+                        // Barycentric weights (either winding)
+                        float wa = ((bx - sx) * (cy - sy) - (by - sy) * (cx - sx)) / area;
+                        float wb = ((cx - sx) * (ay - sy) - (cy - sy) * (ax - sx)) / area;
+                        float wc = 1.0f - wa - wb;
+
+                        if (wa < 0 || wb < 0 || wc < 0) { continue; }
+
+                        this->fragment(px, py, {
+                            wa * a[2] + wb * b[2] + wc * c[2],
+                            wa * a[3] + wb * b[3] + wc * c[3],
+                            wa * a[4] + wb * b[4] + wc * c[4],
+                            wa * a[5] + wb * b[5] + wc * c[5]
+                        });
+                    }
+                }
+            }
+        }
+
+        // Polyline stream: { x, y, width }, { r, g, b, a } per point (expanded as the shader would)
+        void polylines(const float* points, size_t count) {
+
+            const PolylinePoint* stream = reinterpret_cast<const PolylinePoint*>(points);
+
+            expanded.resize(PolylineBatch::segments(stream, count) * PolylineVertsPer);
+            size_t verts = polyline.triangulate(stream, count, expanded.data());
+
+            this->triangles(reinterpret_cast<const float*>(expanded.data()), verts);
+        }
+    };
+};
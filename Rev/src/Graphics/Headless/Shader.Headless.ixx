@@ -0,0 +1,29 @@
+module;
+
+#include <cstddef>
+
+export module Rev.Graphics.Shader;
+
+import Rev.Core.Resource;
+
+export namespace Rev::Graphics {
+
+    using namespace Rev::Core;
+
+    // Shaders are kept (not compiled), there is nothing to run them
+    struct Shader {
+
+        enum Stage {
+            Vertex, Fragment
+        };
+
+        Resource source;
+        Stage stage;
+
+        // Create
+        Shader(Resource shaderFile, Stage shaderType) {
+            source = shaderFile;
+            stage = shaderType;
+        }
+    };
+};
@@ -0,0 +1,85 @@
+module;
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+export module Rev.Graphics.Texture;
+
+import Rev.Graphics.Context;
+
+export namespace Rev::Graphics {
+
+    struct Texture {
+
+        unsigned char* data = nullptr;
+        size_t width, height;
+        size_t channels;
+        size_t size = 0;
+
+        void* context = nullptr;
+
+        // Our copy of the pixels (what the GPU would hold)
+        std::vector<unsigned char> pixels;
+
+        struct Params {
+            
+            unsigned char* data = nullptr;
+
+            size_t width = 0, height = 0;
+            size_t channels = 4;
+        };
+
+        // Create
+        Texture(void* context, Params params) {
+
+            this->context = context;
+            channels = params.channels;
+
+            this->resize(params.data, params.width, params.height);
+        }
+
+        // Reallocate with new dimensions and contents
+        void resize(unsigned char* newData, size_t newWidth, size_t newHeight) {
+
+            data = newData;
+            width = newWidth; height = newHeight;
+            size = width * height * channels;
+
+            pixels.assign(size, 0);
+            if (data) { memcpy(pixels.data(), data, size); }
+
+            upload(context, Context::Upload::Texture, size);
+        }
+
+        // Upload a region of source (which has the same dimensions as the texture)
+        void update(unsigned char* source, size_t x, size_t y, size_t w, size_t h) {
+
+            data = source;
+
+            for (size_t row = y; row < y + h; row++) {
+                size_t offset = (row * width + x) * channels;
+                memcpy(pixels.data() + offset, data + offset, w * channels);
+            }
+
+            upload(context, Context::Upload::Texture, w * h * channels);
+        }
+
+        // Channel value at pixel (clamped to edge)
+        unsigned char at(long x, long y, size_t channel = 0) {
+
+            if (x < 0) { x = 0; } else if (x >= long(width)) { x = long(width) - 1; }
+            if (y < 0) { y = 0; } else if (y >= long(height)) { y = long(height) - 1; }
+
+            return pixels[(size_t(y) * width + size_t(x)) * channels + channel];
+        }
+
+        void bind(unsigned int unit = 0) {
+
+        }
+
+        void unbind(unsigned int unit = 0) {
+
+        }
+    };
+};
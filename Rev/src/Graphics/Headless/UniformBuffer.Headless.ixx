@@ -0,0 +1,56 @@
+module;
+
+#include <cstring>
+#include <cstdlib>
+
+export module Rev.Graphics.UniformBuffer;
+
+import Rev.Graphics.Context;
+
+export namespace Rev::Graphics {
+
+    struct UniformBuffer {
+
+        void* context = nullptr;
+        void* data = nullptr;
+        size_t size = 0;
+
+        // Regions (one per frame in flight)
+        size_t regions = 1;
+
+        UniformBuffer(void* context, size_t size, size_t regions = 1) {
+
+            this->context = context;
+            this->size = size;
+            this->regions = regions;
+
+            data = std::calloc(size * regions, 1);
+        }
+
+        ~UniformBuffer() {
+            std::free(data);
+        }
+
+        void set(void* value, size_t region = 0) {
+            memcpy(static_cast<char*>(data) + region * size, value, size);
+            upload(context, Context::Upload::Uniforms, size);
+        }
+
+        void bind(unsigned int bindingPoint, size_t region = 0) {
+
+        }
+
+        void unbind() {
+
+        }
+
+        // (Nothing is in flight without a GPU, once the render thread is done with a frame)
+        void fence(size_t region) {
+
+        }
+
+        void wait(size_t region) {
+
+        }
+    };
+};
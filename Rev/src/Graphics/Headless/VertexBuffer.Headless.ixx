@@ -0,0 +1,98 @@
+module;
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+export module Rev.Graphics.VertexBuffer;
+
+import Rev.Core.Vertex;
+import Rev.Graphics.Context;
+
+export namespace Rev::Graphics {
+
+    using namespace Rev::Core;
+
+    struct VertexBuffer {
+
+        struct Params {
+
+            size_t divisor = 0;
+            size_t num = 0;
+            size_t window = 1;      // Consecutive records an instance sees
+            size_t regions = 1;     // Copies of num records (one per frame in flight)
+
+            std::vector<size_t> attribs;
+        };
+
+        Params params;
+
+        void* context = nullptr;
+
+        // Buffer data and size (plain memory, all regions), record size
+        void* data = nullptr;
+        size_t size = 0;
+        size_t stride = 0;
+
+        VertexBuffer(void* context, Params params) {
+
+            this->params = params;
+            this->context = context;
+
+            stride = sizeof(float) * std::accumulate(params.attribs.begin(), params.attribs.end(), size_t(0));
+
+            this->params.num = 0;
+            this->resize(params.num);
+        }
+
+        ~VertexBuffer() {
+            std::free(data);
+        }
+
+        // Where a region's records start
+        void* region(size_t index) {
+            return static_cast<char*>(data) + index * params.num * stride;
+        }
+
+        // (Nothing is in flight without a GPU, once the render thread is done with a frame)
+        void fence(size_t index) {
+
+        }
+
+        void wait(size_t index) {
+
+        }
+
+        Vertex* verts() {
+            return static_cast<Vertex*>(data);
+        }
+
+        void set(std::vector<Vertex> newVertices) {
+            memcpy(data, newVertices.data(), size);
+        }
+
+        void resize(size_t newNum) {
+
+            // If no change, do nothing
+            if (newNum == params.num) { return; }
+            else { params.num = newNum; }
+
+            // Calculate buffer size
+            size = params.num * stride * std::max(params.regions, size_t(1));
+
+            // (Contents are discarded, as with the other backends)
+            std::free(data);
+            data = size ? std::calloc(size, 1) : nullptr;
+        }
+
+        void bind() {
+
+        }
+
+        void unbind() {
+
+        }
+    };
+};
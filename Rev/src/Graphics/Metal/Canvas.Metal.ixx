@@ -15,7 +15,11 @@ export module Rev.Graphics.Canvas;
 import Rev.NativeWindow;
 import Rev.Graphics.Pipeline;
 import Rev.Graphics.UniformBuffer;
+import Rev.Graphics.VertexBuffer;
 import Rev.Graphics.FrameBuffer;
+import Rev.Graphics.Texture;
+import Rev.Graphics.Batch;
+import Rev.Graphics.RenderThread;
 
 export namespace Rev::Graphics {
 
@@ -33,6 +37,12 @@ export namespace Rev::Graphics {
             float scale = 1.0f;
         };
 
+        // Per-frame counters
+        struct Stats {
+            size_t drawCalls = 0;
+            size_t stateBinds = 0;
+        };
+
         // Context management
         NativeWindow* window = nullptr;
         MetalContext* context = nullptr;
@@ -43,7 +53,18 @@ export namespace Rev::Graphics {
         Details details;
         Flags flags;
 
-        Canvas(NativeWindow* w = nullptr) {
+        // Batching
+        Stats stats;
+        size_t frame = 0;
+        Batch* pending = nullptr;
+
+        // Currently bound state (to skip redundant binds)
+        Pipeline* boundPipeline = nullptr;
+        VertexBuffer* boundVertices = nullptr;
+
+        // (Metal submits in place, command buffers already run ahead of us, so there's no
+        // render thread to pipeline with)
+        Canvas(NativeWindow* w = nullptr, bool pipelined = false) {
 
             window = w;
 
@@ -79,6 +100,13 @@ export namespace Rev::Graphics {
                 return;
             }
 
+            // New frame, batches start over (and encoder state is fresh)
+            frame += 1;
+            stats = Stats();
+            pending = nullptr;
+            boundPipeline = nullptr;
+            boundVertices = nullptr;
+
             if (flags.resize) {
 
                 details.width = window->size.w;
@@ -108,6 +136,8 @@ export namespace Rev::Graphics {
 
         void endFrame() {
 
+            this->flush();
+
             metal_framebuffer_end_frame(context, frameBuffer->buffer);
             metal_present(context, frameBuffer->buffer);
 
@@ -116,6 +146,19 @@ export namespace Rev::Graphics {
             //metal_end_frame(context);
         }
 
+        // (Frames are submitted in place, so there's nothing in flight to wait for)
+        void finish() {
+
+        }
+
+        void release(Batch* batch) {
+            delete batch;
+        }
+
+        void release(Pipeline* pipeline) {
+            delete pipeline;
+        }
+
         // Stencil management
         //--------------------------------------------------
 
@@ -126,6 +169,8 @@ export namespace Rev::Graphics {
             if (enable == flags.color) { return; }
             else { flags.color = enable; }
 
+            this->flush();
+
         }
 
         // Enable / disable writing to stencil buffer
@@ -135,42 +180,134 @@ export namespace Rev::Graphics {
             if (enable == flags.stencil ) { return; }
             else { flags.stencil = enable; }
 
+            this->flush();
+
         }
 
         // Set stencil depth
         void stencilDepth(size_t depth) {
+            this->flush();
             metal_stencil_depth(context, frameBuffer->buffer, depth);
         }
 
         // Set to all zeroes
         void stencilFill(size_t value = 0) {
+            this->flush();
             metal_stencil_clear(context, frameBuffer->buffer, value);
         }
 
         // Pushing to stencil (increasing depth where test passes)
         void stencilPush(size_t depth) {
+            this->flush();
             metal_stencil_push(context, frameBuffer->buffer, depth);
         }
 
         // Popping from stencil (decreasing depth where test passes)
         void stencilPop(size_t depth) {
+            this->flush();
             metal_stencil_pop(context, frameBuffer->buffer, depth);
         }
 
         // Setting stencil (set depth where test passes)
         void stencilSet(size_t depth) {
+            this->flush();
             metal_stencil_set(context, frameBuffer->buffer, depth);
         }
 
+        // Batching
+        //--------------------------------------------------
+
+        // Get space for records in a batch. Records accumulate until the batch
+        // changes or stencil state does, then are drawn with one call.
+        void* append(Batch* batch, size_t num) {
+
+            // (Regions rotate with frames, so the last ones' records stay put while drawn)
+            if (batch->frame != frame) { batch->reset(frame, frame % RenderThread::slots); }
+
+            // A different batch ends the pending run
+            if (batch != pending) {
+                this->flush();
+                pending = batch;
+            }
+
+            // Out of room, draw what we have before growing
+            if (!batch->fits(num)) {
+                this->flush();
+                delete batch->grow(num);    // (Command buffers keep what they draw from)
+                pending = batch;
+                boundVertices = nullptr;
+            }
+
+            return batch->append(num);
+        }
+
+        // Draw the pending run
+        void flush() {
+
+            if (!pending) { return; }
+
+            Batch& batch = *pending;
+            pending = nullptr;
+
+            size_t count = batch.used - batch.drawn;
+            if (!count) { return; }
+
+            this->bind(batch.pipeline);
+            this->bind(batch.arena);
+
+            if (batch.texture) {
+                batch.texture->bind(0);
+                stats.stateBinds += 1;
+            }
+
+            if (batch.params.instanced) {
+                metal_draw_arrays_instanced(context, batch.params.topology, 0, batch.params.verticesPer, batch.instances(count), batch.base() + batch.drawn);
+            }
+
+            else { metal_draw_arrays(context, batch.params.topology, batch.base() + batch.drawn, count); }
+
+            batch.drawn = batch.used;
+            stats.drawCalls += 1;
+        }
+
+        void bind(Pipeline* pipeline) {
+
+            if (pipeline == boundPipeline) { return; }
+            else { boundPipeline = pipeline; }
+
+            pipeline->bind();
+            stats.stateBinds += 1;
+        }
+
+        void bind(VertexBuffer* vertices) {
+
+            if (vertices == boundVertices) { return; }
+            else { boundVertices = vertices; }
+
+            vertices->bind();
+            stats.stateBinds += 1;
+        }
+
         // Drawing functions
         //--------------------------------------------------
 
+        // (Unbatched, callers flush() before binding their own state)
         void drawArrays(Pipeline::Topology topology, size_t start, size_t verticesPer) {
+
+            boundPipeline = nullptr;
+            boundVertices = nullptr;
+
             metal_draw_arrays(context, topology, start, verticesPer);
+            stats.drawCalls += 1;
         }
 
         void drawArraysInstanced(Pipeline::Topology topology, size_t start, size_t verticesPer, size_t numInstances) {
+
+            boundPipeline = nullptr;
+            boundVertices = nullptr;
+
             metal_draw_arrays_instanced(context, topology, start, verticesPer, numInstances);
+            stats.drawCalls += 1;
         }
     };
 };
\ No newline at end of file
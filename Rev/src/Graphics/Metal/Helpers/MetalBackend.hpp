@@ -21,6 +21,7 @@ void metal_present(MetalContext*c, void* framebuffer);
 // Texture
 void* metal_create_texture(MetalContext* ctx, const unsigned char* data, size_t width, size_t height, size_t channels);
 void metal_destroy_texture(void* texture);
+void metal_update_texture(void* texture, const unsigned char* data, size_t x, size_t y, size_t width, size_t height, size_t stride);
 void metal_bind_texture(MetalContext* ctx, void* texture, int unit);
 void metal_unbind_texture(MetalContext* ctx, int unit);
 
@@ -63,4 +64,4 @@ void  metal_bind_pipeline(MetalContext* ctx, void* pipeline);
 
 // Functions
 void metal_draw_arrays(MetalContext* ctx, int topology, size_t start, size_t verticesPer);
-void metal_draw_arrays_instanced(MetalContext* ctx, int topology, size_t start, size_t verticesPer, size_t numInstances);
\ No newline at end of file
+void metal_draw_arrays_instanced(MetalContext* ctx, int topology, size_t start, size_t verticesPer, size_t numInstances, size_t baseInstance = 0);
\ No newline at end of file
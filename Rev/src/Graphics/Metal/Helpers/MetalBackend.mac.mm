@@ -572,6 +572,19 @@ void metal_destroy_texture(void* texture) {
     delete t;
 }
 
+// Replace a region of the texture (data points at the region's first pixel, stride is in pixels)
+void metal_update_texture(void* texture, const unsigned char* data, size_t x, size_t y, size_t width, size_t height, size_t stride) {
+
+    if (!texture || !data) return;
+    MetalTexture* t = static_cast<MetalTexture*>(texture);
+
+    // RGB textures are expanded on creation, we only update 1/4 channel textures in place
+    if (t->channels == 3) return;
+
+    MTLRegion region = { { (NSUInteger)x, (NSUInteger)y, 0 }, { (NSUInteger)width, (NSUInteger)height, 1 } };
+    [t->tex replaceRegion:region mipmapLevel:0 withBytes:data bytesPerRow:stride * t->channels];
+}
+
 void metal_bind_texture(MetalContext* ctx, void* texture, int unit) {
     if (!ctx || !ctx->enc || !texture) return;
     MetalTexture* t = static_cast<MetalTexture*>(texture);
@@ -855,7 +868,8 @@ void metal_draw_arrays_instanced(MetalContext* ctx,
                                  int topology,     // your enum -> Metal primitive type
                                  size_t start,
                                  size_t verticesPer,
-                                 size_t numInstances) {
+                                 size_t numInstances,
+                                 size_t baseInstance) {
 
     if (!ctx || !ctx->enc) {
         NSLog(@"Couldn't draw instanced arrays!");
@@ -865,5 +879,6 @@ void metal_draw_arrays_instanced(MetalContext* ctx,
     [ctx->enc drawPrimitives:MTLPrimitiveTypeTriangle
                  vertexStart:(NSUInteger)start
                  vertexCount:(NSUInteger)verticesPer
-               instanceCount:(NSUInteger)numInstances];
+               instanceCount:(NSUInteger)numInstances
+                baseInstance:(NSUInteger)baseInstance];
 }
\ No newline at end of file
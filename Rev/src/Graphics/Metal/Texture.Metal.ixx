@@ -53,6 +53,33 @@ export namespace Rev::Graphics {
             }
         }
 
+        // Reallocate with new dimensions and contents
+        void resize(unsigned char* newData, size_t newWidth, size_t newHeight) {
+
+            if (handle) { metal_destroy_texture(handle); }
+
+            data = newData;
+            width = newWidth; height = newHeight;
+
+            handle = metal_create_texture(
+                (MetalContext*)context,
+                static_cast<const unsigned char*>(data),
+                static_cast<int>(width),
+                static_cast<int>(height),
+                static_cast<int>(channels)
+            );
+        }
+
+        // Upload a region of source (which has the same dimensions as the texture)
+        void update(unsigned char* source, size_t x, size_t y, size_t w, size_t h) {
+
+            data = source;
+
+            if (handle) {
+                metal_update_texture(handle, data + (y * width + x) * channels, x, y, w, h, width);
+            }
+        }
+
         void bind(int unit = 0) {
             if (handle) {
                 metal_bind_texture((MetalContext*)context, handle, unit);
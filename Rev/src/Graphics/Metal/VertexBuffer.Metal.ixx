@@ -3,6 +3,7 @@ module;
 #include <cstddef>
 #include <vector>
 #include <numeric>
+#include <algorithm>
 
 #include "./Helpers/MetalBackend.hpp"
 
@@ -20,6 +21,8 @@ export namespace Rev::Graphics {
 
             size_t divisor = 0;
             size_t num = 0;
+            size_t window = 1;      // Consecutive records an instance sees (read by the shader)
+            size_t regions = 1;     // Copies of num records (one per frame in flight)
 
             std::vector<size_t> attribs;
         };
@@ -30,15 +33,18 @@ export namespace Rev::Graphics {
         void* context = nullptr;
         void* buffer = nullptr;
 
-        // Buffer data and size
+        // Buffer data and size (all regions), record size
         void* data = nullptr;
         size_t size = 0;
+        size_t stride = 0;
 
         VertexBuffer(void* context, Params params) {
 
             this->params = params;
             this->context = context;
 
+            stride = sizeof(float) * std::accumulate(params.attribs.begin(), params.attribs.end(), size_t(0));
+
             this->params.num = 0;
             this->resize(params.num);
         }
@@ -50,6 +56,11 @@ export namespace Rev::Graphics {
             }
         }
 
+        // Where a region's records start
+        void* region(size_t index) {
+            return static_cast<char*>(data) + index * params.num * stride;
+        }
+
         Vertex* verts() {
             return static_cast<Vertex*>(data);
         }
@@ -64,9 +75,8 @@ export namespace Rev::Graphics {
             if (newNum == params.num) { return; }
             else { params.num = newNum; }
 
-            // Derive vertex size, calculate needed size
-            size_t vertSize = sizeof(float) * std::accumulate(params.attribs.begin(), params.attribs.end(), 0);
-            size = params.num * vertSize;
+            // Calculate needed size
+            size = params.num * stride * std::max(params.regions, size_t(1));
 
             if (buffer) { metal_destroy_vertex_buffer(buffer); }
 
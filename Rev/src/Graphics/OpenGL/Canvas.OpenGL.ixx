@@ -1,7 +1,9 @@
 module;
 
 #include <stdexcept>
+#include <mutex>
 #include <vector>
+#include <algorithm>
 #include <glew/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -13,9 +15,17 @@ import Rev.NativeWindow;
 import Rev.Graphics.FrameBuffer;
 import Rev.Graphics.Pipeline;
 import Rev.Graphics.UniformBuffer;
+import Rev.Graphics.VertexBuffer;
+import Rev.Graphics.Texture;
+import Rev.Graphics.Batch;
+import Rev.Graphics.RenderThread;
 
 export namespace Rev::Graphics {
 
+    // Drawing is recorded into a packet per frame (commands, with records in the frame's
+    // region of each arena), which is submitted once the frame ends. Either in place, or when
+    // pipelined, by a render thread with its own context (sharing our objects), so recording
+    // the next frame overlaps submitting and presenting this one.
     struct Canvas {
 
         struct Flags {
@@ -30,8 +40,56 @@ export namespace Rev::Graphics {
             float scale = 1.0f;
         };
 
+        // Per-frame counters
+        struct Stats {
+            size_t drawCalls = 0;
+            size_t stateBinds = 0;
+        };
+
+        // A recorded GL call
+        struct Command {
+
+            enum Kind {
+                ColorWrite, StencilWrite, StencilDepth, StencilFill,
+                StencilPush, StencilPop, StencilSet,
+                BindPipeline, BindVertices, BindTexture,
+                Draw
+            };
+
+            Kind kind;
+            size_t value = 0;           // Enabled, or stencil depth / value
+
+            Pipeline* pipeline = nullptr;
+            VertexBuffer* vertices = nullptr;
+            Texture* texture = nullptr;
+
+            Pipeline::Topology topology = Pipeline::Topology::TriangleList;
+            bool instanced = false;
+            size_t first = 0, count = 0;        // Vertices (or instances)
+            size_t verticesPer = 0, base = 0;   // (Instanced)
+        };
+
+        // Everything needed to submit a frame, as it was recorded
+        struct Packet {
+
+            Details details;
+            bool resize = false;
+
+            std::vector<Command> commands;
+
+            std::vector<VertexBuffer*> buffers;     // Drawn from (fenced once submitted)
+            std::vector<VertexBuffer*> retired;     // Replaced while recording (deleted once drawn)
+
+            // Released by primitives (deleted once drawn, see release)
+            std::vector<Batch*> released;
+            std::vector<Pipeline*> releasedPipelines;
+
+            GLsync uploaded = nullptr;              // Our own work while recording (when pipelined)
+        };
+
         // Context management
         void* context = nullptr;  // (context is unused)
+        void* renderContext = nullptr;  // (the render thread's, when pipelined)
         NativeWindow* window = nullptr;
         UniformBuffer* transform = nullptr;
         FrameBuffer* frameBuffer = nullptr;
@@ -40,26 +98,66 @@ export namespace Rev::Graphics {
         Details details;
         Flags flags;
 
+        // Batching
+        Stats stats;
+        size_t frame = 0;
+        Batch* pending = nullptr;
+
+        // Frames in flight, and the slot being recorded
+        RenderThread renderThread;
+        std::vector<Packet> packets;
+        size_t slot = 0;
+
+        // Guards what's released into packets (which may be in flight meanwhile)
+        std::mutex releasing;
+
+        // Currently bound state (as recorded, to skip redundant binds)
+        Pipeline* boundPipeline = nullptr;
+        VertexBuffer* boundVertices = nullptr;
+
         // Create
-        Canvas(NativeWindow* window = nullptr) {
+        Canvas(NativeWindow* window = nullptr, bool pipelined = false) {
 
             this->window = window;
 
             window->makeContextCurrent();
             window->loadGlFunctions();
 
-            glEnable(GL_MULTISAMPLE);
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            transform = new UniformBuffer(context, sizeof(glm::mat4), RenderThread::slots);
+            packets.resize(RenderThread::slots);
+
+            renderThread.submit = [this](size_t slot) { this->submit(slot); };
+            renderThread.retire = [this](size_t slot) { this->retire(slot); };
 
-            transform = new UniformBuffer(context, sizeof(glm::mat4));
-            frameBuffer = new FrameBuffer(context, { .width = 1, .height = 1 });
+            if (pipelined) { renderContext = window->createSharedContext(); }
+
+            // Framebuffers aren't shared between contexts, so it's made where frames are submitted
+            renderThread.start(pipelined, [this]() {
+
+                if (renderContext) { this->window->useContext(renderContext); }
+
+                glEnable(GL_MULTISAMPLE);
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+                frameBuffer = new FrameBuffer(context, { .width = 1, .height = 1 });
+            });
         }
 
         // Destroy
         ~Canvas() {
+
+            renderThread.stop([this]() {
+
+                for (Packet& packet : packets) { this->deleteReleased(packet); }
+                delete frameBuffer;
+
+                if (renderContext) { this->window->useContext(nullptr); }
+            });
+
+            window->destroyContext(renderContext);
+
             delete transform;
-            delete frameBuffer;
         }
 
         // Frame setup / blitting
@@ -69,10 +167,17 @@ export namespace Rev::Graphics {
             
             if (!window) { return; }
 
-            // Ensure cache coherency (wait for flush) before proceeding
-            // (this is because any changes to buffers need to make it to
-            // ram before we can tell the GPU everything is good)
-            glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT | GL_UNIFORM_BARRIER_BIT);
+            // New frame, batches start over
+            frame += 1;
+            stats = Stats();
+            pending = nullptr;
+            boundPipeline = nullptr;
+            boundVertices = nullptr;
+
+            // Record into the next slot, once the GPU is done with the frame it last held
+            // (replacing a memory barrier, as buffers are coherent but still being read)
+            slot = renderThread.acquire();
+            Packet& packet = packets[slot];
 
             // If canvas needs to adjust size to window
             if (flags.resize) {
@@ -82,59 +187,54 @@ export namespace Rev::Graphics {
                 details.height = window->size.h;
                 details.scale = window->scale;
 
-                glViewport(0, 0, (GLint)std::round(details.width), (GLint)std::round(details.height));
-
-                glm::mat4 projection = glm::ortho(
-                    0.0f, static_cast<float>(details.width) / details.scale - 0.5f,     // Left / right
-                    static_cast<float>(details.height) / details.scale - 0.5f, 0.0f,    // Bottom / top
-                    -1.0f, 1.0f                                                         // Near / far
-                );
-
-                // Resize framebuffer, bind transform
-                frameBuffer->resize(details.width, details.height);
-                transform->set(&projection);
+                packet.resize = true;
                 flags.resize = false;
             }
 
-            // Framebuffer
-            frameBuffer->bind();
-            glEnable(GL_MULTISAMPLE);
-            glDisable(GL_DEPTH_TEST);
+            packet.details = details;
 
-            // Blend func and color
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            glBlendColor(1.0f, 1.0f, 1.0f, 1.0f);
-
-            // Stencil
-            glEnable(GL_STENCIL_TEST);
-            glStencilMask(0xFF);
-
-            // Clear before drawing
-            glClearStencil(0x00);
-            glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-            glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+            glm::mat4 projection = glm::ortho(
+                0.0f, static_cast<float>(details.width) / details.scale - 0.5f,     // Left / right
+                static_cast<float>(details.height) / details.scale - 0.5f, 0.0f,    // Bottom / top
+                -1.0f, 1.0f                                                         // Near / far
+            );
 
-            transform->bind(0);
+            // (Each slot has its own transform, as it may still be read for an earlier frame)
+            transform->set(&projection, slot);
         }
 
-        // We end the frame by blitting and swapping buffers (present)
+        // We end the frame by handing it off to be submitted, blitted and swapped (present)
         void endFrame() {
 
-            // Bind both render target and actual (window) framebuffer
-            glBindFramebuffer(GL_READ_FRAMEBUFFER, frameBuffer->buffer);
-            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            this->flush();
 
-            // Copy (blit)
-            glBlitFramebuffer(
-                0, 0, details.width, details.height,
-                0, 0, details.width, details.height,
-                GL_COLOR_BUFFER_BIT, GL_NEAREST
-            );
+            // The render thread's context must wait for what ours uploaded (glyphs, new arenas)
+            if (renderContext) {
+                packets[slot].uploaded = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                glFlush();
+            }
 
-            // Unbind and swap
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
-            window->swapBuffers();
+            renderThread.push(slot);
+        }
+
+        // Wait until no frame in flight draws with anything (before destroying what they might)
+        void finish() {
+            renderThread.finish();
+        }
+
+        // Delete a batch (or pipeline) once no frame in flight draws with it, without waiting for
+        // them. It goes with the slot last recorded into, when that is retired (frames retire in
+        // order, so earlier ones are done by then). That's where frames are submitted, so when
+        // pipelined the render thread deletes its arena's VAO, which was made there (VAOs aren't
+        // shared between contexts).
+        void release(Batch* batch) {
+            std::lock_guard<std::mutex> lock(releasing);
+            packets[slot].released.push_back(batch);
+        }
+
+        void release(Pipeline* pipeline) {
+            std::lock_guard<std::mutex> lock(releasing);
+            packets[slot].releasedPipelines.push_back(pipeline);
         }
 
         // Stencil management
@@ -147,9 +247,8 @@ export namespace Rev::Graphics {
             if (enable == flags.color) { return; }
             else { flags.color = enable; }
 
-            // Set color mask to enable/disable writing
-            if (enable) { glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE); }
-            else { glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE); }
+            this->flush();
+            this->record({ .kind = Command::ColorWrite, .value = enable });
         }
 
         // Enable / disable writing to stencil buffer
@@ -159,55 +258,323 @@ export namespace Rev::Graphics {
             if (enable == flags.stencil ) { return; }
             else { flags.stencil = enable; }
 
-            // Set stencil mask to enable/disable writing
-            if (enable) { glStencilMask(0xFF); }
-            else { glStencilMask(0x00); }
+            this->flush();
+            this->record({ .kind = Command::StencilWrite, .value = enable });
         }
 
         // Set stencil depth
         void stencilDepth(size_t value) {
-            glStencilFunc(GL_LEQUAL, value, 0xFF);
+            this->flush();
+            this->record({ .kind = Command::StencilDepth, .value = value });
         }
 
         // Set to all zeroes
         void stencilClear() {
-            glClearStencil(0.0f);
-            glClear(GL_STENCIL_BUFFER_BIT);
+            this->stencilFill(0);
         }
 
         // Fill stencil buffer with uniform value(s)
         void stencilFill(size_t value) {
-            glClearStencil(value);
-            glClear(GL_STENCIL_BUFFER_BIT);
+            this->flush();
+            this->record({ .kind = Command::StencilFill, .value = value });
         }
 
         // Pushing to stencil (increasing depth where test passes)
         void stencilPush(size_t depth) {
-            glStencilFunc(GL_LEQUAL, depth, 0xFF);
-            glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+            this->flush();
+            this->record({ .kind = Command::StencilPush, .value = depth });
         }
 
         // Popping from stencil (decreasing depth where test passes)
         void stencilPop(size_t depth) {
-            glStencilFunc(GL_LEQUAL, depth, 0xFF);
-            glStencilOp(GL_KEEP, GL_KEEP, GL_DECR);
+            this->flush();
+            this->record({ .kind = Command::StencilPop, .value = depth });
         }
 
         // Setting stencil (set depth where test passes)
         void stencilSet(size_t depth) {
-            glStencilFunc(GL_LEQUAL, depth, 0xFF);
-            glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+            this->flush();
+            this->record({ .kind = Command::StencilSet, .value = depth });
+        }
+
+        // Batching
+        //--------------------------------------------------
+
+        // Get space for records in a batch. Records accumulate until the batch
+        // changes or stencil state does, then are drawn with one call.
+        void* append(Batch* batch, size_t num) {
+
+            if (batch->frame != frame) { batch->reset(frame, slot); }
+
+            // A different batch ends the pending run
+            if (batch != pending) {
+                this->flush();
+                pending = batch;
+            }
+
+            // Out of room, draw what we have before growing (the old arena goes with the frame)
+            if (!batch->fits(num)) {
+                this->flush();
+                packets[slot].retired.push_back(batch->grow(num));
+                pending = batch;
+                boundVertices = nullptr;
+            }
+
+            return batch->append(num);
+        }
+
+        // Draw the pending run
+        void flush() {
+
+            if (!pending) { return; }
+
+            Batch& batch = *pending;
+            pending = nullptr;
+
+            size_t count = batch.used - batch.drawn;
+            if (!count) { return; }
+
+            this->bind(batch.pipeline);
+            this->bind(batch.arena);
+
+            if (batch.texture) {
+                this->record({ .kind = Command::BindTexture, .texture = batch.texture });
+                stats.stateBinds += 1;
+            }
+
+            // (Records of this frame start at its region)
+            size_t first = batch.base() + batch.drawn;
+
+            if (batch.params.instanced) {
+                this->record({
+                    .kind = Command::Draw,
+                    .topology = batch.params.topology,
+                    .instanced = true,
+                    .count = batch.instances(count),
+                    .verticesPer = batch.params.verticesPer,
+                    .base = first
+                });
+            }
+
+            else { this->record({ .kind = Command::Draw, .topology = batch.params.topology, .first = first, .count = count }); }
+
+            batch.drawn = batch.used;
+            stats.drawCalls += 1;
+        }
+
+        void bind(Pipeline* pipeline) {
+
+            if (pipeline == boundPipeline) { return; }
+            else { boundPipeline = pipeline; }
+
+            this->record({ .kind = Command::BindPipeline, .pipeline = pipeline });
+            stats.stateBinds += 1;
+        }
+
+        void bind(VertexBuffer* vertices) {
+
+            if (vertices == boundVertices) { return; }
+            else { boundVertices = vertices; }
+
+            this->record({ .kind = Command::BindVertices, .vertices = vertices });
+            stats.stateBinds += 1;
+
+            // Fenced once submitted
+            std::vector<VertexBuffer*>& buffers = packets[slot].buffers;
+            if (std::find(buffers.begin(), buffers.end(), vertices) == buffers.end()) { buffers.push_back(vertices); }
+        }
+
+        void record(Command command) {
+            packets[slot].commands.push_back(command);
         }
 
         // Drawing functions
         //--------------------------------------------------
 
+        // (Unbatched, callers flush() and bind() their own state first)
         void drawArrays(Pipeline::Topology topology, size_t start, size_t verticesPer) {
-            glDrawArrays(topology, start, verticesPer);
+
+            boundPipeline = nullptr;
+            boundVertices = nullptr;
+
+            this->record({ .kind = Command::Draw, .topology = topology, .first = start, .count = verticesPer });
+            stats.drawCalls += 1;
         }
 
         void drawArraysInstanced(Pipeline::Topology topology, size_t start, size_t verticesPer, size_t numInstances) {
-            glDrawArraysInstanced(GL_TRIANGLE_FAN, start, verticesPer, numInstances);
+
+            boundPipeline = nullptr;
+            boundVertices = nullptr;
+
+            this->record({
+                .kind = Command::Draw,
+                .topology = Pipeline::Topology::TriangleFan,
+                .instanced = true,
+                .first = start, .count = numInstances,
+                .verticesPer = verticesPer
+            });
+
+            stats.drawCalls += 1;
+        }
+
+        // Submitting (where frames are submitted, maybe the render thread)
+        //--------------------------------------------------
+
+        void submit(size_t slot) {
+
+            Packet& packet = packets[slot];
+            Details& details = packet.details;
+
+            // Wait (on the GPU) for what the recording side uploaded meanwhile
+            if (packet.uploaded) {
+                glWaitSync(packet.uploaded, 0, GL_TIMEOUT_IGNORED);
+                glDeleteSync(packet.uploaded);
+                packet.uploaded = nullptr;
+            }
+
+            if (packet.resize) {
+
+                glViewport(0, 0, (GLint)std::round(details.width), (GLint)std::round(details.height));
+
+                frameBuffer->resize(details.width, details.height);
+                packet.resize = false;
+            }
+
+            // Framebuffer
+            frameBuffer->bind();
+            glEnable(GL_MULTISAMPLE);
+            glDisable(GL_DEPTH_TEST);
+
+            // Blend func and color
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glBlendColor(1.0f, 1.0f, 1.0f, 1.0f);
+
+            // Stencil
+            glEnable(GL_STENCIL_TEST);
+            glStencilMask(0xFF);
+
+            // Clear before drawing
+            glClearStencil(0x00);
+            glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+            transform->bind(0, slot);
+
+            for (Command& command : packet.commands) {
+                this->execute(command);
+            }
+
+            // Bind both render target and actual (window) framebuffer
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, frameBuffer->buffer);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+            // Copy (blit)
+            glBlitFramebuffer(
+                0, 0, details.width, details.height,
+                0, 0, details.width, details.height,
+                GL_COLOR_BUFFER_BIT, GL_NEAREST
+            );
+
+            // Once the GPU gets here, this frame's regions can be written again
+            for (VertexBuffer* buffer : packet.buffers) { buffer->fence(slot); }
+            transform->fence(slot);
+
+            // Unbind and swap
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            window->swapBuffers();
+        }
+
+        // Wait until the GPU is done with a slot's frame, then free what it replaced
+        void retire(size_t slot) {
+
+            Packet& packet = packets[slot];
+
+            for (VertexBuffer* buffer : packet.buffers) { buffer->wait(slot); }
+            transform->wait(slot);
+
+            for (VertexBuffer* buffer : packet.retired) { delete buffer; }
+
+            packet.commands.clear();
+            packet.buffers.clear();
+            packet.retired.clear();
+
+            this->deleteReleased(packet);
+        }
+
+        void deleteReleased(Packet& packet) {
+
+            std::lock_guard<std::mutex> lock(releasing);
+
+            for (Batch* batch : packet.released) { delete batch; }
+            for (Pipeline* pipeline : packet.releasedPipelines) { delete pipeline; }
+
+            packet.released.clear();
+            packet.releasedPipelines.clear();
+        }
+
+        void execute(Command& command) {
+
+            switch (command.kind) {
+
+                // Set color mask to enable/disable writing
+                case (Command::ColorWrite): {
+                    if (command.value) { glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE); }
+                    else { glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE); }
+                    break;
+                }
+
+                // Set stencil mask to enable/disable writing
+                case (Command::StencilWrite): {
+                    if (command.value) { glStencilMask(0xFF); }
+                    else { glStencilMask(0x00); }
+                    break;
+                }
+
+                case (Command::StencilDepth): {
+                    glStencilFunc(GL_LEQUAL, command.value, 0xFF);
+                    break;
+                }
+
+                case (Command::StencilFill): {
+                    glClearStencil(command.value);
+                    glClear(GL_STENCIL_BUFFER_BIT);
+                    break;
+                }
+
+                case (Command::StencilPush): {
+                    glStencilFunc(GL_LEQUAL, command.value, 0xFF);
+                    glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+                    break;
+                }
+
+                case (Command::StencilPop): {
+                    glStencilFunc(GL_LEQUAL, command.value, 0xFF);
+                    glStencilOp(GL_KEEP, GL_KEEP, GL_DECR);
+                    break;
+                }
+
+                case (Command::StencilSet): {
+                    glStencilFunc(GL_LEQUAL, command.value, 0xFF);
+                    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+                    break;
+                }
+
+                case (Command::BindPipeline): { command.pipeline->bind(); break; }
+                case (Command::BindVertices): { command.vertices->bind(); break; }
+                case (Command::BindTexture): { command.texture->bind(0); break; }
+
+                case (Command::Draw): {
+
+                    if (command.instanced) {
+                        glDrawArraysInstancedBaseInstance(command.topology, command.first, command.verticesPer, command.count, command.base);
+                    }
+
+                    else { glDrawArrays(command.topology, command.first, command.count); }
+
+                    break;
+                }
+            }
         }
     };
 };
\ No newline at end of file
@@ -69,6 +69,54 @@ export namespace Rev::Graphics {
             if (id) { glDeleteTextures(1, &id); }
         }
 
+        // Determine format
+        GLenum format() {
+            if (channels == 3) { return GL_RGB; }
+            if (channels == 4) { return GL_RGBA; }
+            return GL_RED;
+        }
+
+        // Reallocate with new dimensions and contents
+        void resize(unsigned char* newData, size_t newWidth, size_t newHeight) {
+
+            data = newData;
+            width = newWidth; height = newHeight;
+
+            glBindTexture(GL_TEXTURE_2D, id);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+            glTexImage2D(
+                GL_TEXTURE_2D, 0, format(),
+                static_cast<GLsizei>(width),
+                static_cast<GLsizei>(height),
+                0, format(), GL_UNSIGNED_BYTE, data
+            );
+
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+
+        // Upload a region of source (which has the same dimensions as the texture)
+        void update(unsigned char* source, size_t x, size_t y, size_t w, size_t h) {
+
+            data = source;
+
+            glBindTexture(GL_TEXTURE_2D, id);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(width));
+
+            glTexSubImage2D(
+                GL_TEXTURE_2D, 0,
+                static_cast<GLint>(x), static_cast<GLint>(y),
+                static_cast<GLsizei>(w), static_cast<GLsizei>(h),
+                format(), GL_UNSIGNED_BYTE, data + (y * width + x) * channels
+            );
+
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+
         void bind(GLuint unit = 0) {
             glActiveTexture(GL_TEXTURE0 + unit);
             glBindTexture(GL_TEXTURE_2D, id);
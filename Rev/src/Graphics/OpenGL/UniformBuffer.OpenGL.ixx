@@ -1,6 +1,7 @@
 module;
 
 #include <glew/glew.h>
+#include <vector>
 #include <cstring>
 #include <dbg.hpp>
 
@@ -14,20 +15,34 @@ export namespace Rev::Graphics {
         void* data = nullptr;
         size_t size = 0;
 
-        UniformBuffer(void* context, size_t size) {
+        // Regions (one per frame in flight), each aligned as binding requires
+        size_t regions = 1;
+        size_t stride = 0;
+
+        // Per region, set once the GPU has been told to read it
+        std::vector<GLsync> fences;
+
+        UniformBuffer(void* context, size_t size, size_t regions = 1) {
 
             this->size = size;
+            this->regions = regions;
+
+            GLint alignment = 256;
+            glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+            stride = (size + alignment - 1) / alignment * alignment;
+            fences.assign(regions, nullptr);
 
             glGenBuffers(1, &bufferID);
             glBindBuffer(GL_UNIFORM_BUFFER, bufferID);
 
-            glBufferStorage(GL_UNIFORM_BUFFER, size, nullptr,
+            glBufferStorage(GL_UNIFORM_BUFFER, stride * regions, nullptr,
                 GL_MAP_WRITE_BIT |
                 GL_MAP_PERSISTENT_BIT |
                 GL_MAP_COHERENT_BIT
             );
 
-            data = glMapBufferRange(GL_UNIFORM_BUFFER, 0, size,
+            data = glMapBufferRange(GL_UNIFORM_BUFFER, 0, stride * regions,
                 GL_MAP_WRITE_BIT |
                 GL_MAP_PERSISTENT_BIT |
                 GL_MAP_COHERENT_BIT
@@ -40,6 +55,10 @@ export namespace Rev::Graphics {
 
             //dbg("[UniformBuffer] destroying");
 
+            for (GLsync& fence : fences) {
+                if (fence) { glDeleteSync(fence); }
+            }
+
             if (data) {
                 glBindBuffer(GL_UNIFORM_BUFFER, bufferID);
                 glUnmapBuffer(GL_UNIFORM_BUFFER);
@@ -50,16 +69,41 @@ export namespace Rev::Graphics {
             }
         }
 
-        void set(void* value) {
-            memcpy(data, value, size);
+        void set(void* value, size_t region = 0) {
+            memcpy(static_cast<char*>(data) + region * stride, value, size);
         }
 
-        void bind(GLuint bindingPoint) {
-            glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, bufferID);
+        void bind(GLuint bindingPoint, size_t region = 0) {
+            glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, bufferID, region * stride, size);
         }
 
         void unbind() {
             glBindBuffer(GL_UNIFORM_BUFFER, 0);
         }
+
+        // Fencing
+        //--------------------------------------------------
+
+        // Mark a region as read by everything issued so far
+        void fence(size_t region) {
+
+            if (fences[region]) { glDeleteSync(fences[region]); }
+            fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+
+        // Wait until the GPU is done reading a region (so it can be written again)
+        void wait(size_t region) {
+
+            if (!fences[region]) { return; }
+
+            GLenum result = GL_TIMEOUT_EXPIRED;
+
+            while (result == GL_TIMEOUT_EXPIRED) {
+                result = glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            }
+
+            glDeleteSync(fences[region]);
+            fences[region] = nullptr;
+        }
     };
 };
\ No newline at end of file
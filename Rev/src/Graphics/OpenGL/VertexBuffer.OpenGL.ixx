@@ -2,6 +2,7 @@ module;
 
 #include <vector>
 #include <numeric>
+#include <algorithm>
 #include <glew/glew.h>
 
 export module Rev.Graphics.VertexBuffer;
@@ -18,26 +19,33 @@ export namespace Rev::Graphics {
 
             size_t divisor = 0;
             size_t num = 0;
+            size_t window = 1;      // Consecutive records an instance sees (as attribs repeated per record)
+            size_t regions = 1;     // Copies of num records (one per frame in flight)
 
             std::vector<size_t> attribs;
         };
 
         Params params;
 
-        // Track buffer
+        // Track buffer (and which of its allocations the VAO was set up for)
         GLuint vaoID = 0;
         GLuint bufferID = 0;
+        size_t allocation = 0, vaoAllocation = 0;
 
-        // Buffer data and size
+        // Buffer data and size (all regions), record size
         void* data = nullptr;
         size_t size = 0;
+        size_t stride = 0;
+
+        // Per region, set once the GPU has been told to draw from it
+        std::vector<GLsync> fences;
 
         VertexBuffer(void* context, Params params) {
 
             this->params = params;
 
-            glGenVertexArrays(1, &vaoID);
-            glBindVertexArray(vaoID);
+            stride = sizeof(float) * std::accumulate(params.attribs.begin(), params.attribs.end(), size_t(0));
+            fences.assign(std::max(params.regions, size_t(1)), nullptr);
 
             this->params.num = 0;
             this->resize(params.num);
@@ -45,6 +53,10 @@ export namespace Rev::Graphics {
 
         ~VertexBuffer() {
 
+            for (GLsync& fence : fences) {
+                if (fence) { glDeleteSync(fence); }
+            }
+
             if (data) {
                 glBindBuffer(GL_ARRAY_BUFFER, bufferID);
                 glUnmapBuffer(GL_ARRAY_BUFFER); // optional if persistent
@@ -53,6 +65,41 @@ export namespace Rev::Graphics {
             if (bufferID) {
                 glDeleteBuffers(1, &bufferID);
             }
+
+            // (Deleted where it was made, see Canvas::release)
+            if (vaoID) {
+                glDeleteVertexArrays(1, &vaoID);
+            }
+        }
+
+        // Where a region's records start
+        void* region(size_t index) {
+            return static_cast<char*>(data) + index * params.num * stride;
+        }
+
+        // Fencing
+        //--------------------------------------------------
+
+        // Mark a region as drawn from by everything issued so far
+        void fence(size_t index) {
+
+            if (fences[index]) { glDeleteSync(fences[index]); }
+            fences[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+
+        // Wait until the GPU is done drawing from a region (so it can be written again)
+        void wait(size_t index) {
+
+            if (!fences[index]) { return; }
+
+            GLenum result = GL_TIMEOUT_EXPIRED;
+
+            while (result == GL_TIMEOUT_EXPIRED) {
+                result = glClientWaitSync(fences[index], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            }
+
+            glDeleteSync(fences[index]);
+            fences[index] = nullptr;
         }
 
         Vertex* verts() {
@@ -69,9 +116,8 @@ export namespace Rev::Graphics {
             if (newNum == params.num) { return; }
             else { params.num = newNum; }
 
-            // Derive vertex size, calculate buffer size
-            size_t vertSize = sizeof(float) * std::accumulate(params.attribs.begin(), params.attribs.end(), 0);
-            size = params.num * vertSize;
+            // Calculate buffer size
+            size = params.num * stride * fences.size();
             
             // Delete previous buffer
             if (data) {
@@ -85,10 +131,9 @@ export namespace Rev::Graphics {
                 bufferID = 0;
             }
         
-            glBindVertexArray(vaoID);
-        
             glGenBuffers(1, &bufferID);
             glBindBuffer(GL_ARRAY_BUFFER, bufferID);
+            allocation += 1;
         
             glBufferStorage(GL_ARRAY_BUFFER, size, nullptr,
                 GL_MAP_WRITE_BIT |
@@ -102,25 +147,40 @@ export namespace Rev::Graphics {
                 GL_MAP_COHERENT_BIT
             );
 
-            size_t idx = 0, offset = 0;
-            for (size_t attrib : params.attribs) {
-
-                glVertexAttribPointer(idx, attrib, GL_FLOAT, GL_FALSE, vertSize, (void*)(offset * sizeof(float)));
-                glEnableVertexAttribArray(idx);
-
-                idx += 1;
-                offset += attrib;
-            }
-        
-            if (params.divisor) {
-                glVertexAttribDivisor(0, params.divisor);
-            }
-        
-            glBindVertexArray(0);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
         }
 
+        // The VAO is made (and set up for the current buffer) where the buffer is drawn from,
+        // as VAOs aren't shared between contexts (when pipelined, the render thread's)
         void bind() {
+
+            if (!vaoID) { glGenVertexArrays(1, &vaoID); }
             glBindVertexArray(vaoID);
+
+            if (vaoAllocation == allocation) { return; }
+            else { vaoAllocation = allocation; }
+
+            glBindBuffer(GL_ARRAY_BUFFER, bufferID);
+
+            // (Windows overlap: record k of an instance's window is the record k after its own)
+            size_t idx = 0;
+            for (size_t k = 0; k < std::max(params.window, size_t(1)); k++) {
+
+                size_t offset = k * stride / sizeof(float);
+                for (size_t attrib : params.attribs) {
+
+                    glVertexAttribPointer(idx, attrib, GL_FLOAT, GL_FALSE, stride, (void*)(offset * sizeof(float)));
+                    glEnableVertexAttribArray(idx);
+
+                    // Instanced attributes advance per instance
+                    if (params.divisor) {
+                        glVertexAttribDivisor(idx, params.divisor);
+                    }
+
+                    idx += 1;
+                    offset += attrib;
+                }
+            }
         }
 
         void unbind() {
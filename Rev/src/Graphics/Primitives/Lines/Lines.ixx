@@ -2,6 +2,7 @@ module;
 
 #include <cmath>
 #include <vector>
+#include <cstring>
 #include "./TriangulatePolyline.hpp"
 
 export module Rev.Primitive.Lines;
@@ -13,32 +14,43 @@ import Rev.Core.Vertex;
 import Rev.Core.Rect;
 
 import Rev.Graphics.Canvas;
-import Rev.Graphics.UniformBuffer;
-import Rev.Graphics.VertexBuffer;
 import Rev.Graphics.Pipeline;
 import Rev.Graphics.Shader;
+import Rev.Graphics.Batch;
 
 // Shader file resources
 import Resources.Shaders.OpenGL.Lines.Lines_vert;
 import Resources.Shaders.OpenGL.Lines.Lines_frag;
+import Resources.Shaders.OpenGL.Lines.Polyline_vert;
 import Resources.Shaders.Metal.Lines.Lines_metal;
+import Resources.Shaders.Metal.Lines.Polyline_metal;
 
 export namespace Rev::Primitive {
 
     struct Lines : public Primitive {
 
-        // Instance-specific data
-        struct Data {
-            Color color = { 1, 1, 1, 1 };
+        // Where segments (and joins) are expanded into triangles. Either way, lines are first
+        // packed into one stream of points (see TriangulatePolyline.hpp), which the GPU expands
+        // with an instance per segment, or the CPU does all at once (vectorized).
+        enum Mode {
+            Gpu, Cpu
         };
 
+        inline static Mode defaultMode = Gpu;
+
         inline static Shared shared;
         inline static Pipeline* pipeline;
+        inline static Pipeline* polylinePipeline;
+        inline static Batch* batch = nullptr;
+        inline static Batch* polylineBatch = nullptr;
+
+        inline static PolylineBatch triangulator;
 
-        UniformBuffer* databuff = nullptr;
-        VertexBuffer* vertices = nullptr;
+        Mode mode = defaultMode;
+
+        std::vector<PolylinePoint> points;      // Stream of all lines
+        std::vector<Vertex> vertices;           // (Expanded, for Cpu mode)
 
-        Data* data = nullptr;
         bool dirty = true;
 
         Color color = { 1, 1, 1, 1 };
@@ -52,7 +64,7 @@ export namespace Rev::Primitive {
             Color color = { 1, 1, 1, 1 };
             float strokeWidth = 0.0f;
 
-            size_t segs, quads, joins, verts;
+            size_t segs = 0;
 
             // Allow valid pointer to override points
             std::vector<Vertex>& getPoints() {
@@ -63,7 +75,7 @@ export namespace Rev::Primitive {
 
         std::vector<Line> lines;
 
-        size_t numSegments, numQuads, numJoins, numVerts;
+        size_t numSegments = 0, numVerts = 0;
 
         // Create
         Lines(Canvas* canvas, std::vector<std::vector<Vertex>*> pLines = {}) : Primitive(canvas) {
@@ -73,7 +85,7 @@ export namespace Rev::Primitive {
                 lines.push_back({ .pPoints = pPoints });
             }
 
-            // Create shared pipeline
+            // Create shared pipelines
             shared.create([canvas]() {
                 pipeline = new Pipeline(canvas->context, {
 
@@ -84,77 +96,105 @@ export namespace Rev::Primitive {
                     .openGlFrag = Lines_frag,
                     .metalUniversal = Lines_metal
                 });
-            });
 
-            vertices = new VertexBuffer(canvas->context, { .attribs = { 2, 4 } });
-            databuff = new UniformBuffer(canvas->context, sizeof(Data));
+                // (Points are read by the shader, four to an instance)
+                polylinePipeline = new Pipeline(canvas->context, {
+
+                    .instanced = true,
+                    .attribs = {},
 
-            data = (Data*)databuff->data;
-            *data = Data();
+                    .openGlVert = Polyline_vert,
+                    .openGlFrag = Lines_frag,
+                    .metalUniversal = Polyline_metal
+                });
+
+                batch = new Batch(canvas->context, pipeline, { .instanced = false, .reserve = 4096, .attribs = { 2, 4 } });
+
+                polylineBatch = new Batch(canvas->context, polylinePipeline, {
+                    .verticesPer = PolylineVertsPer,
+                    .reserve = 1024,
+                    .window = 4,
+                    .attribs = { 3, 4 }
+                });
+            });
         }
 
         // Destroy
         ~Lines() {
 
-            shared.destroy([]() {
-                delete pipeline;
+            shared.destroy([this]() {
+                canvas->release(polylineBatch);
+                canvas->release(batch);
+                canvas->release(polylinePipeline);
+                canvas->release(pipeline);
             });
-
-            delete vertices;
-            delete databuff;
         }
 
         void compute() override {
 
             // Reset
-            numSegments = numQuads = numJoins = numVerts = 0;
+            numSegments = numVerts = 0;
+            points.clear();
+
+            // Pack lines into the stream, each followed by a separator
+            PolylinePoint separator = { 0, 0, 0, 0, 0, 0, -1 };
 
-            // Calculate needed quads/joins/verts
             for (Line& line : lines) {
 
-                // Deref, disqualify if too small
-                std::vector<Vertex>& points = line.getPoints();
+                std::vector<Vertex>& rPoints = line.getPoints();
+                float width = strokeWidth ? strokeWidth : line.strokeWidth;
 
-                // Calculate for line
-                line.segs = points.size() - 1;
-                line.quads = line.segs;
-                line.joins = line.segs - 1;
-                line.verts = 6 * line.quads + 3 * line.joins;
+                line.segs = 0;
+                if (rPoints.size() < 2) { continue; }
 
-                // Sum globally
-                numVerts += line.verts;
-            }
+                if (points.empty()) { points.push_back(separator); }
 
-            // Resize vertex buffer to match needed/expected vertices
-            vertices->resize(numVerts);
+                size_t start = points.size();
 
-            size_t offset = 0;
+                for (Vertex& point : rPoints) {
 
-            for (Line& line : lines) {
+                    // Repeated points make no segment
+                    if (points.size() > start && points.back().x == point.x && points.back().y == point.y) { continue; }
 
-                std::vector<Vertex>& rPoints = line.getPoints();
-                Vertex* pVerts = vertices->verts();
+                    // Points without color take ours
+                    Color c = (point.color.a == 0.0f) ? color : point.color;
 
-                int numTriangles = triangulatePolyline(
-                    reinterpret_cast<float*>(rPoints.data()), rPoints.size(),
-                    reinterpret_cast<float*>(pVerts + offset), line.verts,
-                    strokeWidth ? strokeWidth : line.strokeWidth
-                );
+                    points.push_back({ point.x, point.y, width, c.r, c.g, c.b, c.a });
+                }
 
-                offset += line.verts;
+                // Disqualify if too small
+                if (points.size() - start < 2) {
+                    points.resize(start);
+                    continue;
+                }
+
+                points.push_back(separator);
+
+                line.segs = points.size() - start - 2;
+                numSegments += line.segs;
             }
 
-            data->color = color;
+            if (mode == Gpu) { return; }
+
+            // Expand every line at once
+            numVerts = numSegments * PolylineVertsPer;
+            vertices.resize(numVerts);
+
+            triangulator.triangulate(points.data(), points.size(), reinterpret_cast<Vec2*>(vertices.data()));
         }
 
         void draw() override {
 
-            pipeline->bind();
+            if (!numSegments) { return; }
+
+            if (mode == Gpu) {
+                void* records = canvas->append(polylineBatch, points.size());
+                std::memcpy(records, points.data(), points.size() * sizeof(PolylinePoint));
+                return;
+            }
 
-            databuff->bind(1);
-            vertices->bind();
-            
-            canvas->drawArrays(Pipeline::Topology::TriangleList, 0, numVerts);
+            Vertex* verts = static_cast<Vertex*>(canvas->append(batch, numVerts));
+            std::memcpy(verts, vertices.data(), numVerts * sizeof(Vertex));
         }
     };
-};
\ No newline at end of file
+};
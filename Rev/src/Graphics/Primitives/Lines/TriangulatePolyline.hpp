@@ -1,137 +1,403 @@
 #pragma once
 #include <cmath>
 #include <cstdint>
+#include <cstddef>
+#include <vector>
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// Output vertex
 struct Vec2 {
     float x, y, r, g, b, a;
 };
 
-struct Quad {
-    Vec2 a, b, c, d; // a,b = inner; c,d = outer
+// A point of a polyline stream. Lines follow one another in a stream, each between
+// separators (points with negative alpha), so every segment sees its neighbours:
+//
+//     [ sep, p0, p1, p2, sep, q0, q1, sep ]
+//
+// Segment i of a stream is the window [ i, i + 3 ] (previous, start, end, next point),
+// and is only a segment if its start and end aren't separators.
+struct PolylinePoint {
+    float x, y, width, r, g, b, a;
 };
 
-struct Tri {
-    Vec2 a, b, c;
+// Vertices per segment: its quad, then the triangle filling the outside of its join with the next
+constexpr size_t PolylineVertsPer = 9;
+
+// Reference
+//--------------------------------------------------
+
+// Expand the segment of a window (see above) into its vertices, returning false if it
+// isn't one. Segment ends are mitred against their neighbours, so the quads of a line
+// meet along the inside of each join, which its triangle closes on the outside.
+//
+// The Lines shader and the batch triangulator follow this operation for operation.
+inline bool expandSegment(const PolylinePoint* window, Vec2* out) {
+
+    const PolylinePoint& A = window[0];
+    const PolylinePoint& B = window[1];
+    const PolylinePoint& C = window[2];
+    const PolylinePoint& D = window[3];
+
+    if (B.a < 0 || C.a < 0) return false;
+
+    float halfT = B.width * 0.5f;
+
+    // Direction and (half thickness) normal
+    float dx = C.x - B.x, dy = C.y - B.y;
+    float len = std::sqrt(dx * dx + dy * dy);
+    float ux = dx / len, uy = dy / len;
+    float hx = -uy * halfT, hy = ux * halfT;
+
+    Vec2 a{ B.x + hx, B.y + hy }, b{ B.x - hx, B.y - hy };
+    Vec2 c{ C.x - hx, C.y - hy }, d{ C.x + hx, C.y + hy };
+
+    // Inside of the join with the previous segment
+    if (A.a >= 0) {
+
+        float pdx = B.x - A.x, pdy = B.y - A.y;
+        float plen = std::sqrt(pdx * pdx + pdy * pdy);
+        float pux = pdx / plen, puy = pdy / plen;
+        float phx = -puy * halfT, phy = pux * halfT;
+
+        float cross = pux * uy - puy * ux;
+        float side = cross < 0 ? -1.0f : 1.0f;
+
+        float i1x = A.x + side * phx, i1y = A.y + side * phy;
+        float i2x = B.x + side * hx, i2y = B.y + side * hy;
+
+        float t = ((i2x - i1x) * uy - (i2y - i1y) * ux) / cross;
+
+        Vec2 join{ i2x, i2y };
+        if (std::fabs(cross) > 1e-3f) { join = { i1x + pux * t, i1y + puy * t }; }
+
+        if (cross < 0) { b = join; }
+        else { a = join; }
+    }
+
+    // Join with the next segment (the triangle is empty without one)
+    Vec2 o1{ C.x, C.y }, o2{ C.x, C.y }, join{ C.x, C.y };
+
+    if (D.a >= 0) {
+
+        float ndx = D.x - C.x, ndy = D.y - C.y;
+        float nlen = std::sqrt(ndx * ndx + ndy * ndy);
+        float nux = ndx / nlen, nuy = ndy / nlen;
+        float nhx = -nuy * halfT, nhy = nux * halfT;
+
+        float cross = ux * nuy - uy * nux;
+        float side = cross < 0 ? -1.0f : 1.0f;
+
+        float i1x = B.x + side * hx, i1y = B.y + side * hy;
+        float i2x = C.x + side * nhx, i2y = C.y + side * nhy;
+
+        float t = ((i2x - i1x) * nuy - (i2y - i1y) * nux) / cross;
+
+        join = { i2x, i2y };
+        if (std::fabs(cross) > 1e-3f) { join = { i1x + ux * t, i1y + uy * t }; }
+
+        if (cross < 0) { c = join; }
+        else { d = join; }
+
+        o1 = { C.x - side * hx, C.y - side * hy };
+        o2 = { C.x - side * nhx, C.y - side * nhy };
+    }
+
+    // Start takes the color of B, the rest that of C
+    for (Vec2* v : { &a, &b }) { v->r = B.r; v->g = B.g; v->b = B.b; v->a = B.a; }
+    for (Vec2* v : { &c, &d, &o1, &o2, &join }) { v->r = C.r; v->g = C.g; v->b = C.b; v->a = C.a; }
+
+    out[0] = a; out[1] = b; out[2] = c;
+    out[3] = a; out[4] = c; out[5] = d;
+    out[6] = o1; out[7] = o2; out[8] = join;
+
+    return true;
+}
+
+// Expand every segment of a stream one by one, returning vertices written
+inline size_t triangulatePolyline(const PolylinePoint* points, size_t count, Vec2* out) {
+
+    size_t written = 0;
+
+    for (size_t i = 0; i + 3 < count; i++) {
+        if (expandSegment(points + i, out + written)) { written += PolylineVertsPer; }
+    }
+
+    return written;
+}
+
+// Batch
+//--------------------------------------------------
+
+namespace PolylineSimd {
+
+#if defined(__AVX__)
+
+    using Reg = __m256;
+    constexpr size_t Width = 8;
+
+    inline Reg load(const float* p) { return _mm256_loadu_ps(p); }
+    inline void store(float* p, Reg v) { _mm256_storeu_ps(p, v); }
+    inline Reg set(float v) { return _mm256_set1_ps(v); }
+
+    inline Reg add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+    inline Reg sub(Reg a, Reg b) { return _mm256_sub_ps(a, b); }
+    inline Reg mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+    inline Reg div(Reg a, Reg b) { return _mm256_div_ps(a, b); }
+    inline Reg sqrt(Reg a) { return _mm256_sqrt_ps(a); }
+
+    inline Reg less(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    inline Reg greater(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    inline Reg greaterEqual(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+
+    inline Reg both(Reg a, Reg b) { return _mm256_and_ps(a, b); }
+    inline Reg select(Reg mask, Reg a, Reg b) { return _mm256_blendv_ps(b, a, mask); }
+    inline Reg negate(Reg a) { return _mm256_xor_ps(a, set(-0.0f)); }
+    inline Reg abs(Reg a) { return _mm256_andnot_ps(set(-0.0f), a); }
+    inline int bits(Reg mask) { return _mm256_movemask_ps(mask); }
+
+#elif defined(__SSE2__) || defined(_M_X64)
+
+    using Reg = __m128;
+    constexpr size_t Width = 4;
+
+    inline Reg load(const float* p) { return _mm_loadu_ps(p); }
+    inline void store(float* p, Reg v) { _mm_storeu_ps(p, v); }
+    inline Reg set(float v) { return _mm_set1_ps(v); }
+
+    inline Reg add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+    inline Reg sub(Reg a, Reg b) { return _mm_sub_ps(a, b); }
+    inline Reg mul(Reg a, Reg b) { return _mm_mul_ps(a, b); }
+    inline Reg div(Reg a, Reg b) { return _mm_div_ps(a, b); }
+    inline Reg sqrt(Reg a) { return _mm_sqrt_ps(a); }
+
+    inline Reg less(Reg a, Reg b) { return _mm_cmplt_ps(a, b); }
+    inline Reg greater(Reg a, Reg b) { return _mm_cmpgt_ps(a, b); }
+    inline Reg greaterEqual(Reg a, Reg b) { return _mm_cmpge_ps(a, b); }
+
+    inline Reg both(Reg a, Reg b) { return _mm_and_ps(a, b); }
+    inline Reg select(Reg mask, Reg a, Reg b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+    inline Reg negate(Reg a) { return _mm_xor_ps(a, set(-0.0f)); }
+    inline Reg abs(Reg a) { return _mm_andnot_ps(set(-0.0f), a); }
+    inline int bits(Reg mask) { return _mm_movemask_ps(mask); }
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+    using Reg = float32x4_t;
+    constexpr size_t Width = 4;
+
+    inline Reg load(const float* p) { return vld1q_f32(p); }
+    inline void store(float* p, Reg v) { vst1q_f32(p, v); }
+    inline Reg set(float v) { return vdupq_n_f32(v); }
+
+    inline Reg add(Reg a, Reg b) { return vaddq_f32(a, b); }
+    inline Reg sub(Reg a, Reg b) { return vsubq_f32(a, b); }
+    inline Reg mul(Reg a, Reg b) { return vmulq_f32(a, b); }
+    inline Reg div(Reg a, Reg b) { return vdivq_f32(a, b); }
+    inline Reg sqrt(Reg a) { return vsqrtq_f32(a); }
+
+    inline Reg mask(uint32x4_t m) { return vreinterpretq_f32_u32(m); }
+    inline uint32x4_t lanes(Reg m) { return vreinterpretq_u32_f32(m); }
+
+    inline Reg less(Reg a, Reg b) { return mask(vcltq_f32(a, b)); }
+    inline Reg greater(Reg a, Reg b) { return mask(vcgtq_f32(a, b)); }
+    inline Reg greaterEqual(Reg a, Reg b) { return mask(vcgeq_f32(a, b)); }
+
+    inline Reg both(Reg a, Reg b) { return mask(vandq_u32(lanes(a), lanes(b))); }
+    inline Reg select(Reg m, Reg a, Reg b) { return vbslq_f32(lanes(m), a, b); }
+    inline Reg negate(Reg a) { return vnegq_f32(a); }
+    inline Reg abs(Reg a) { return vabsq_f32(a); }
+
+    inline int bits(Reg m) {
+        uint32x4_t top = vshrq_n_u32(lanes(m), 31);
+        return int(vgetq_lane_u32(top, 0) | (vgetq_lane_u32(top, 1) << 1) | (vgetq_lane_u32(top, 2) << 2) | (vgetq_lane_u32(top, 3) << 3));
+    }
+
+#else
+
+    constexpr size_t Width = 0;
+
+#endif
 };
 
-int32_t triangulatePolyline(float* polylineFloats, int32_t polylineCount,
-                            float* triangleFloats, int32_t triangleCount, float thickness) {
-
-    if (polylineCount < 2) return 0;
-
-    Vec2* polyline  = reinterpret_cast<Vec2*>(polylineFloats);
-    Vec2* triangles = reinterpret_cast<Vec2*>(triangleFloats);
-
-    const float halfT = thickness * 0.5f;
-    int32_t triOut = 0;
-
-    // --- Build initial segment quad ---
-    Vec2 A = polyline[0];
-    Vec2 B = polyline[1];
-
-    Vec2 dir{ B.x - A.x, B.y - A.y };
-    float len = std::hypot(dir.x, dir.y);
-    if (len == 0) return 0;
-
-    dir.x /= len;
-    dir.y /= len;
-    Vec2 perp{ -dir.y, dir.x };
-
-    Quad thisQuad = {
-        { A.x + perp.x * halfT, A.y + perp.y * halfT, A.r, A.g, A.b, A.a }, // A+
-        { A.x - perp.x * halfT, A.y - perp.y * halfT, A.r, A.g, A.b, A.a }, // A-
-        { B.x - perp.x * halfT, B.y - perp.y * halfT, B.r, B.g, B.b, B.a }, // B-
-        { B.x + perp.x * halfT, B.y + perp.y * halfT, B.r, B.g, B.b, B.a }  // B+
-    };
-
-    // --- Iterate through remaining segments ---
-    for (int32_t i = 1; i < polylineCount - 1; ++i) {
-
-        Vec2 C = polyline[i + 1];
-
-        Vec2 dirNext{ C.x - B.x, C.y - B.y };
-        float lenNext = std::hypot(dirNext.x, dirNext.y);
-        bool hasNext = (lenNext > 0);
-        if (!hasNext) continue;
-
-        dirNext.x /= lenNext;
-        dirNext.y /= lenNext;
-        Vec2 perpNext{ -dirNext.y, dirNext.x };
-
-        // Build next quad for BC
-        Quad nextQuad = {
-            { B.x + perpNext.x * halfT, B.y + perpNext.y * halfT },
-            { B.x - perpNext.x * halfT, B.y - perpNext.y * halfT },
-            { C.x - perpNext.x * halfT, C.y - perpNext.y * halfT },
-            { C.x + perpNext.x * halfT, C.y + perpNext.y * halfT }
-        };
-
-        // Compute join geometry
-        float cross = dir.x * dirNext.y - dir.y * dirNext.x;
-
-        Vec2 inner1, inner2, outer1, outer2;
-        
-        if (cross < 0) {
-            inner1 = thisQuad.b;
-            inner2 = nextQuad.b;
-            outer1 = thisQuad.d;
-            outer2 = nextQuad.a;
-        } else {
-            inner1 = thisQuad.a;
-            inner2 = nextQuad.a;
-            outer1 = thisQuad.c;
-            outer2 = nextQuad.b;
-        }
+// Expands whole streams (any number of lines) in one pass, a vector of segments at a time,
+// giving the same vertices as expandSegment(). Points are first split into one array per
+// component, so the four points of each lane's window are plain loads at offsets 0 to 3.
+struct PolylineBatch {
 
-        float denom = dir.x * dirNext.y - dir.y * dirNext.x;
-        Vec2 innerJoin = inner2;
-        if (std::fabs(denom) > 1e-3f) {
-            float t = ((inner2.x - inner1.x) * dirNext.y - (inner2.y - inner1.y) * dirNext.x) / denom;
-            innerJoin = { inner1.x + dir.x * t, inner1.y + dir.y * t };
-        }
+    // Components of the stream's points
+    std::vector<float> xs, ys, widths, alphas;
+
+    // Segments in a stream (what it expands to is PolylineVertsPer times that)
+    static size_t segments(const PolylinePoint* points, size_t count) {
 
-        // Construct and emit join triangle
-        Tri joinCap{ outer1, outer2, innerJoin };
-        triangles[triOut + 0] = joinCap.a;
-        triangles[triOut + 1] = joinCap.b;
-        triangles[triOut + 2] = joinCap.c;
-        triOut += 3;
-
-        // Apply shared vertex correction
-        if (cross < 0) {
-            // Right turn → inside = right
-            thisQuad.c = innerJoin;  // current segment’s end inner
-            nextQuad.b = innerJoin;  // next segment’s start inner
-        } else {
-            // Left turn → inside = left
-            thisQuad.d = innerJoin;  // current segment’s end inner
-            nextQuad.a = innerJoin;  // next segment’s start inner
+        size_t num = 0;
+
+        for (size_t i = 1; i + 2 < count; i++) {
+            num += points[i].a >= 0 && points[i + 1].a >= 0;
         }
 
-        // ✅ Emit corrected current quad (after join adjustment)
-        triangles[triOut + 0] = thisQuad.a;
-        triangles[triOut + 1] = thisQuad.b;
-        triangles[triOut + 2] = thisQuad.c;
-        triangles[triOut + 3] = thisQuad.a;
-        triangles[triOut + 4] = thisQuad.c;
-        triangles[triOut + 5] = thisQuad.d;
-        triOut += 6;
-
-        // Move forward
-        thisQuad = nextQuad;
-        A = B;
-        B = C;
-        dir = dirNext;
+        return num;
     }
 
-    // Emit final segment (no next)
-    triangles[triOut + 0] = thisQuad.a;
-    triangles[triOut + 1] = thisQuad.b;
-    triangles[triOut + 2] = thisQuad.c;
-    triangles[triOut + 3] = thisQuad.a;
-    triangles[triOut + 4] = thisQuad.c;
-    triangles[triOut + 5] = thisQuad.d;
-    triOut += 6;
+    size_t triangulate(const PolylinePoint* points, size_t count, Vec2* out) {
 
-    return triOut / 3;
-}
+        if (count < 4) return 0;
+
+#if !defined(__AVX__) && !defined(__SSE2__) && !defined(_M_X64) && !(defined(__ARM_NEON) && defined(__aarch64__))
+        return triangulatePolyline(points, count, out);
+#else
+        using namespace PolylineSimd;
+
+        size_t windows = count - 3;
+        size_t written = 0;
+        size_t i = 0;
+
+        xs.resize(count); ys.resize(count);
+        widths.resize(count); alphas.resize(count);
+
+        for (size_t p = 0; p < count; p++) {
+            xs[p] = points[p].x;
+            ys[p] = points[p].y;
+            widths[p] = points[p].width;
+            alphas[p] = points[p].a;
+        }
+
+        const Reg zero = set(0.0f), half = set(0.5f), epsilon = set(1e-3f);
+
+        // Lanes' positions: a, b, c, d, outer 1, outer 2, inner join (x, y each)
+        alignas(32) float lanes[14][Width];
+
+        for (; i + Width <= windows; i += Width) {
+
+            Reg isB = greaterEqual(load(&alphas[i + 1]), zero);
+            Reg isC = greaterEqual(load(&alphas[i + 2]), zero);
+            int segmentBits = bits(both(isB, isC));
+
+            if (!segmentBits) continue;
+
+            Reg Ax = load(&xs[i]), Ay = load(&ys[i]);
+            Reg Bx = load(&xs[i + 1]), By = load(&ys[i + 1]);
+            Reg Cx = load(&xs[i + 2]), Cy = load(&ys[i + 2]);
+            Reg Dx = load(&xs[i + 3]), Dy = load(&ys[i + 3]);
+
+            Reg halfT = mul(load(&widths[i + 1]), half);
+
+            // Direction and (half thickness) normal
+            Reg dx = sub(Cx, Bx), dy = sub(Cy, By);
+            Reg len = sqrt(add(mul(dx, dx), mul(dy, dy)));
+            Reg ux = div(dx, len), uy = div(dy, len);
+            Reg hx = mul(negate(uy), halfT), hy = mul(ux, halfT);
+
+            Reg ax = add(Bx, hx), ay = add(By, hy), bx = sub(Bx, hx), by = sub(By, hy);
+            Reg cx = sub(Cx, hx), cy = sub(Cy, hy), ddx = add(Cx, hx), ddy = add(Cy, hy);
+
+            // Inside of the join with the previous segment
+            {
+                Reg pdx = sub(Bx, Ax), pdy = sub(By, Ay);
+                Reg plen = sqrt(add(mul(pdx, pdx), mul(pdy, pdy)));
+                Reg pux = div(pdx, plen), puy = div(pdy, plen);
+                Reg phx = mul(negate(puy), halfT), phy = mul(pux, halfT);
+
+                Reg cross = sub(mul(pux, uy), mul(puy, ux));
+                Reg right = less(cross, zero);
+
+                Reg i1x = add(Ax, select(right, negate(phx), phx)), i1y = add(Ay, select(right, negate(phy), phy));
+                Reg i2x = add(Bx, select(right, negate(hx), hx)), i2y = add(By, select(right, negate(hy), hy));
+
+                Reg t = div(sub(mul(sub(i2x, i1x), uy), mul(sub(i2y, i1y), ux)), cross);
+
+                Reg mitre = greater(abs(cross), epsilon);
+                Reg jx = select(mitre, add(i1x, mul(pux, t)), i2x);
+                Reg jy = select(mitre, add(i1y, mul(puy, t)), i2y);
+
+                Reg isA = greaterEqual(load(&alphas[i]), zero);
+                Reg toB = both(isA, right), toA = select(right, zero, isA);
+
+                bx = select(toB, jx, bx); by = select(toB, jy, by);
+                ax = select(toA, jx, ax); ay = select(toA, jy, ay);
+            }
+
+            // Join with the next segment
+            Reg o1x = Cx, o1y = Cy, o2x = Cx, o2y = Cy, jx = Cx, jy = Cy;
+            {
+                Reg ndx = sub(Dx, Cx), ndy = sub(Dy, Cy);
+                Reg nlen = sqrt(add(mul(ndx, ndx), mul(ndy, ndy)));
+                Reg nux = div(ndx, nlen), nuy = div(ndy, nlen);
+                Reg nhx = mul(negate(nuy), halfT), nhy = mul(nux, halfT);
+
+                Reg cross = sub(mul(ux, nuy), mul(uy, nux));
+                Reg right = less(cross, zero);
+
+                Reg shx = select(right, negate(hx), hx), shy = select(right, negate(hy), hy);
+                Reg snx = select(right, negate(nhx), nhx), sny = select(right, negate(nhy), nhy);
+
+                Reg i1x = add(Bx, shx), i1y = add(By, shy);
+                Reg i2x = add(Cx, snx), i2y = add(Cy, sny);
+
+                Reg t = div(sub(mul(sub(i2x, i1x), nuy), mul(sub(i2y, i1y), nux)), cross);
+
+                Reg mitre = greater(abs(cross), epsilon);
+                Reg mx = select(mitre, add(i1x, mul(ux, t)), i2x);
+                Reg my = select(mitre, add(i1y, mul(uy, t)), i2y);
+
+                Reg isD = greaterEqual(load(&alphas[i + 3]), zero);
+                Reg toC = both(isD, right), toD = select(right, zero, isD);
+
+                cx = select(toC, mx, cx); cy = select(toC, my, cy);
+                ddx = select(toD, mx, ddx); ddy = select(toD, my, ddy);
+
+                jx = select(isD, mx, Cx); jy = select(isD, my, Cy);
+                o1x = select(isD, sub(Cx, shx), Cx); o1y = select(isD, sub(Cy, shy), Cy);
+                o2x = select(isD, sub(Cx, snx), Cx); o2y = select(isD, sub(Cy, sny), Cy);
+            }
+
+            store(lanes[0], ax); store(lanes[1], ay);
+            store(lanes[2], bx); store(lanes[3], by);
+            store(lanes[4], cx); store(lanes[5], cy);
+            store(lanes[6], ddx); store(lanes[7], ddy);
+            store(lanes[8], o1x); store(lanes[9], o1y);
+            store(lanes[10], o2x); store(lanes[11], o2y);
+            store(lanes[12], jx); store(lanes[13], jy);
+
+            // Write out the lanes which are segments, with their colors
+            for (size_t lane = 0; lane < Width; lane++) {
+
+                if (!(segmentBits & (1 << lane))) continue;
+
+                const PolylinePoint& B = points[i + lane + 1];
+                const PolylinePoint& C = points[i + lane + 2];
+
+                Vec2 a{ lanes[0][lane], lanes[1][lane], B.r, B.g, B.b, B.a };
+                Vec2 b{ lanes[2][lane], lanes[3][lane], B.r, B.g, B.b, B.a };
+                Vec2 c{ lanes[4][lane], lanes[5][lane], C.r, C.g, C.b, C.a };
+                Vec2 d{ lanes[6][lane], lanes[7][lane], C.r, C.g, C.b, C.a };
+
+                Vec2* v = out + written;
+
+                v[0] = a; v[1] = b; v[2] = c;
+                v[3] = a; v[4] = c; v[5] = d;
+                v[6] = { lanes[8][lane], lanes[9][lane], C.r, C.g, C.b, C.a };
+                v[7] = { lanes[10][lane], lanes[11][lane], C.r, C.g, C.b, C.a };
+                v[8] = { lanes[12][lane], lanes[13][lane], C.r, C.g, C.b, C.a };
+
+                written += PolylineVertsPer;
+            }
+        }
+
+        // Remainder
+        for (; i < windows; i++) {
+            if (expandSegment(points + i, out + written)) { written += PolylineVertsPer; }
+        }
+
+        return written;
+#endif
+    }
+};
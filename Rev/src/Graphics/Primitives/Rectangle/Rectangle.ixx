@@ -10,10 +10,9 @@ import Rev.Core.Pos;
 
 // Rev graphics modules
 import Rev.Graphics.Canvas;
-import Rev.Graphics.UniformBuffer;
-import Rev.Graphics.VertexBuffer;
 import Rev.Graphics.Pipeline;
 import Rev.Graphics.Shader;
+import Rev.Graphics.Batch;
 
 // Shader resources
 import Resources.Shaders.Metal.Rectangle.Rectangle_metal;
@@ -25,7 +24,7 @@ export namespace Rev::Primitive {
 
     struct Rectangle : public Primitive {
 
-        // Instance-specific data
+        // Instance-specific data (one instance record)
         struct Data {
 
             struct Rect { float x, y, w, h; };
@@ -40,9 +39,11 @@ export namespace Rev::Primitive {
         inline static Shared shared;
         inline static Pipeline* pipeline = nullptr;
         inline static Pipeline* stencilPipeline = nullptr;
-        inline static VertexBuffer* vertices = nullptr;
 
-        UniformBuffer* databuff = nullptr;
+        // Shared instance arenas
+        inline static Batch* batch = nullptr;
+        inline static Batch* stencilBatch = nullptr;
+
         Data* data = nullptr;
 
         // Create
@@ -53,7 +54,7 @@ export namespace Rev::Primitive {
                 // Color pipeline
                 pipeline = new Pipeline(canvas->context, {
 
-                    .attribs = { 2, 4 },
+                    .attribs = { 4, 4, 4 },
 
                     .openGlVert = Rectangle_vert,
                     .openGlFrag = Rectangle_frag,
@@ -62,19 +63,18 @@ export namespace Rev::Primitive {
 
                 stencilPipeline = new Pipeline(canvas->context, {
 
-                    .attribs = { 2, 4 },
+                    .attribs = { 4, 4, 4 },
 
                     .openGlVert = Rectangle_vert,
                     .openGlFrag = Rectangle_frag,
                     .metalUniversal = RectangleStencil_metal
                 });
 
-                vertices = new VertexBuffer(canvas->context, { .num = 6, .divisor = 1, .attribs = { 2, 4 } });
+                batch = new Batch(canvas->context, pipeline, { .attribs = { 4, 4, 4 } });
+                stencilBatch = new Batch(canvas->context, stencilPipeline, { .attribs = { 4, 4, 4 } });
             });
 
-            //vertices = new VertexBuffer(4);
-            databuff = new UniformBuffer(canvas->context, sizeof(Data));
-            data = static_cast<Data*>(databuff->data);
+            data = new Data();
 
             *data = {
                 .rect = { .x = 100, .y = 100, .w = 100, .h = 100 },
@@ -86,13 +86,14 @@ export namespace Rev::Primitive {
         // Destroy
         ~Rectangle() {
 
-            shared.destroy([]() {
-                delete pipeline;
-                delete stencilPipeline;
-                delete vertices;
+            shared.destroy([this]() {
+                canvas->release(batch);
+                canvas->release(stencilBatch);
+                canvas->release(pipeline);
+                canvas->release(stencilPipeline);
             });
             
-            delete databuff;
+            delete data;
         }
 
         void compute() override {
@@ -101,22 +102,12 @@ export namespace Rev::Primitive {
 
         // Draw stencil
         void stencil() {
-
-            stencilPipeline->bind();
-            vertices->bind();
-            databuff->bind(1);
-
-            canvas->drawArraysInstanced(Pipeline::Topology::TriangleList, 0, 6, 1);
+            *static_cast<Data*>(canvas->append(stencilBatch, 1)) = *data;
         }
 
         // Draw color
         void draw() override {
-         
-            pipeline->bind();
-            vertices->bind();
-            databuff->bind(1);
-
-            canvas->drawArraysInstanced(Pipeline::Topology::TriangleList, 0, 6, 1);
+            *static_cast<Data*>(canvas->append(batch, 1)) = *data;
         }
     };
 };
\ No newline at end of file
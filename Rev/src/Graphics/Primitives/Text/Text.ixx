@@ -1,21 +1,26 @@
 module;
 
 #include <cmath>
+#include <map>
+#include <tuple>
 #include <vector>
 #include <string>
+#include <cstring>
+#include <algorithm>
+#include <functional>
 
 export module Rev.Primitive.Text;
 
 import Rev.Primitive;
 import Rev.Core.Shared;
 import Rev.Core.Font;
+import Rev.Core.Resource;
 import Rev.Core.Pos;
 
 import Rev.Graphics.Canvas;
-import Rev.Graphics.UniformBuffer;
-import Rev.Graphics.VertexBuffer;
 import Rev.Graphics.Pipeline;
 import Rev.Graphics.Shader;
+import Rev.Graphics.Batch;
 
 // Resources
 import Resources.Fonts.Arial.Arial_ttf;
@@ -27,10 +32,10 @@ export namespace Rev::Primitive {
 
     struct Text : public Primitive {
 
-        // Position and texture coords
-        struct CharVertex {
-            float x, y;
-            float u, v;
+        // Per-glyph instance: quad relative to text position, and its region in the atlas (pixels)
+        struct CharInstance {
+            float x, y, w, h;
+            float u, v, uw, vh;
         };
 
         // Instance-specific data
@@ -43,23 +48,38 @@ export namespace Rev::Primitive {
             Pos pos;
         };
 
+        // Glyph as appended to the batch (positioned and colored)
+        struct Record {
+            CharInstance glyph;
+            Data::Color color;
+        };
+
         inline static Shared shared;
         inline static Pipeline* pipeline;
+        inline static Batch* batch = nullptr;
 
-        UniformBuffer* databuff = nullptr;
-        VertexBuffer* vertices = nullptr;
+        std::vector<CharInstance> instances;        // (Of every line, relative to text position)
+
+        // Glyphs as drawn, placed at our position and colored. Kept between frames, so only
+        // glyphs laid out again (or all, once we move or change color) are placed again.
+        std::vector<Record> records;
+        size_t placedStart = 0, placedEnd = 0;     // Instances whose records are up to date
+        Data placedData = {};
 
         Font* font = nullptr;
         Data* data = nullptr;
 
+        // Set through setContent() / addContent(), which note how much stays the same
         std::string content = "Hello World";
+        Resource resource = Arial_ttf;
         float fontSize = 12.0f;
+        size_t numGlyphs = 0;
 
         struct Line {
-            std::string dbg;    // Debug
-            size_t start, end;  // Start and end of line
-            float x, y;         // x, y position of line
+            size_t start, end;      // Bytes of content (end exclusive)
+            float x, y;             // x, y position of line
             float w, h;
+            size_t first, count;    // Its glyph instances
         };
 
         struct Dims {
@@ -80,22 +100,22 @@ export namespace Rev::Primitive {
                 
                 pipeline = new Pipeline(canvas->context, {
 
-                    .attribs = { 4 },
+                    .attribs = { 4, 4, 4 },
                     
                     .openGlVert = Text_vert,
                     .openGlFrag = Text_frag,
 
                     .metalUniversal = Text_metal
                 });
+
+                batch = new Batch(canvas->context, pipeline, { .reserve = 4096, .attribs = { 4, 4, 4 } });
             });
 
             this->content = content;
 
-            font = new Font(canvas);
-            vertices = new VertexBuffer(canvas->context, { .divisor = 1, .attribs = { 4 } });
-            databuff = new UniformBuffer(canvas->context, sizeof(Data));
+            font = Font::acquire(canvas, resource, fontSize, canvas->details.scale);
 
-            data = static_cast<Data*>(databuff->data);
+            data = new Data();
             *data = {
                 .color = { 1, 1, 1, 1 }
             };
@@ -104,14 +124,64 @@ export namespace Rev::Primitive {
         // Destroy
         ~Text() {
 
-            // Destroy shared pipeline
-            shared.destroy([]() {
-                delete pipeline;
+            shared.destroy([this]() {
+                canvas->release(batch);
+                canvas->release(pipeline);
+                cache.clear();
             });
 
-            delete vertices;
-            delete databuff;
-            delete font;
+            delete data;
+
+            this->releaseFont(font);
+        }
+
+        // Ensure font matches size / scale (fonts are cached, so this is cheap)
+        void matchFont() {
+
+            if (font->size == fontSize && font->scale == canvas->details.scale && font->resource.data == resource.data) {
+                return;
+            }
+
+            Font* previous = font;
+            font = Font::acquire(canvas, resource, fontSize, canvas->details.scale);
+            this->releaseFont(previous);
+        }
+
+        // Frames in flight may still draw glyphs of a font we were the last to use
+        void releaseFont(Font* previous) {
+
+            if (previous->users == 1) { canvas->finish(); }
+
+            Font::release(previous);
+        }
+
+        // Content
+        //--------------------------------------------------
+
+        void setContent(const std::string& newContent) {
+
+            // Whatever the old content shares with the new is still measured / laid out
+            size_t same = 0;
+            size_t shortest = std::min(content.size(), newContent.size());
+
+            while (same < shortest && content[same] == newContent[same]) { same += 1; }
+
+            if (same == content.size() && same == newContent.size()) { return; }
+
+            this->edited(same);
+            content = newContent;
+        }
+
+        void addContent(const std::string& more) {
+            this->edited(content.size());
+            content += more;
+        }
+
+        // Note content changed from a byte on (measuring only continues past appends)
+        void edited(size_t from) {
+            if (from < measured.bytes) { measured.bytes = 0; }
+            laidOut = std::min(laidOut, from);
+            relayout = true;
         }
 
         // Measure / layout
@@ -128,35 +198,44 @@ export namespace Rev::Primitive {
             float minWidth = 0; float maxWidth = 0;
             float maxHeight = 0; float minHeight = 0;
         };
-        
+
+        struct Tracked {
+            float current = 0;
+            float max = 0;
+            float min = 99999999;
+        };
+
+        // Where measuring got to (so appended content continues from there), for which font
+        // (by id, as the address of an evicted font may be reused)
+        struct Measured {
+            size_t fontId = 0;
+            size_t bytes = 0;
+            Tracked letter, word, line;
+        };
+
         WrapMode mode = WrapMode::BreakChar;
         MinMax minMax;
-        
-        MinMax measure() {
+        Measured measured;
 
-            // Ensure font size matches
-            if (font->size != fontSize || font->scale != canvas->details.scale) {
-                delete font;
-                font = new Font(canvas, Arial_ttf, fontSize, canvas->details.scale);
-            }
+        MinMax measure() {
 
-            float xl = 0, yl = 0;
-            float xr = 0, yr = 0;
+            this->matchFont();
 
-            struct Tracked {
-                float current = 0;
-                float max = 0;
-                float min = 99999999;
-            };
+            // Start over for another font (or if what was measured changed from the start)
+            if (measured.fontId != font->id || measured.bytes == 0) { measured = { .fontId = font->id }; }
 
             Font& fontRef = *font;
-            Tracked letter, word, line;
-        
-            // Iterate through each character in the content
-            for (char c : content) {
+            Tracked& letter = measured.letter;
+            Tracked& word = measured.word;
+            Tracked& line = measured.line;
+
+            // Iterate through each character not yet measured
+            for (size_t idx = measured.bytes; idx < content.size();) {
+
+                char32_t c = Font::next(content, idx);
 
                 // Track current
-                letter.current = fontRef.glyphs[c].advance;
+                letter.current = fontRef.glyph(c).advance;
                 word.current += letter.current;
                 line.current += letter.current;
 
@@ -178,35 +257,33 @@ export namespace Rev::Primitive {
                 }
             }
 
-            // Min/max any that weren't caught in the loop
-            //--------------------------------------------------
-
-            letter.min = std::min(letter.min, letter.current);
-            letter.max = std::max(letter.max, letter.current);
+            measured.bytes = content.size();
 
-            word.min = std::min(word.min, word.current);
-            word.max = std::max(word.max, word.current);
+            // Min/max any that weren't caught in the loop (leaving the tracked state as is)
+            //--------------------------------------------------
 
-            line.min = std::min(line.min, line.current);
-            line.max = std::max(line.max, line.current);
+            float letterMax = std::max(letter.max, letter.current);
+            float wordMax = std::max(word.max, word.current);
+            float lineMin = std::min(line.min, line.current);
+            float lineMax = std::max(line.max, line.current);
 
             switch (mode) {
 
                 case (WrapMode::None): {
-                    minMax.minWidth = line.min;
-                    minMax.maxWidth = line.max;
+                    minMax.minWidth = lineMin;
+                    minMax.maxWidth = lineMax;
                     break;
                 }
 
                 case (WrapMode::BreakChar): {
-                    minMax.minWidth = letter.max;
-                    minMax.maxWidth = line.max;
+                    minMax.minWidth = letterMax;
+                    minMax.maxWidth = lineMax;
                     break;
                 }
 
                 case (WrapMode::BreakWord): {
-                    minMax.minWidth = word.max;
-                    minMax.maxWidth = line.max;
+                    minMax.minWidth = wordMax;
+                    minMax.maxWidth = lineMax;
                     break;
                 }
             }
@@ -214,54 +291,98 @@ export namespace Rev::Primitive {
             return minMax;
         }
 
+        // Layout cache
+        //--------------------------------------------------
+
+        // Short texts, once laid out, are shared by every text with the same content, font
+        // (by id, which covers size and scale), wrap width and mode, e.g. labels and values which recur
+        using Key = std::tuple<size_t, size_t, float, WrapMode>;
+
+        struct Shaped {
+            std::string content;
+            std::vector<Line> lines;
+            std::vector<CharInstance> instances;
+            Dims dims;
+        };
+
+        static constexpr size_t cacheableBytes = 256;
+        static constexpr size_t cacheLimit = 4096;
+
+        inline static std::map<Key, Shaped> cache;
+
+        // What the lines were laid out for, and how many bytes of content they still hold
+        size_t layoutFontId = 0;
+        float wrapWidth = 99999999.0f;
+        WrapMode layoutMode = WrapMode::BreakChar;
+        size_t laidOut = 0;
+        bool relayout = true;
+
+        // Lay out lines to fit a width, placing their glyphs. Lines before an edit are kept
+        // (appending only lays out the last line or two), and unchanged content isn't looked at.
         Dims layout(float maxWidth) {
 
-            // Ensure font size matches
-            if (font->size != fontSize || font->scale != canvas->details.scale) {
-                delete font;
-                font = new Font(canvas, Arial_ttf, fontSize, canvas->details.scale);
+            this->matchFont();
+
+            // Anything but content changing starts over
+            if (font->id != layoutFontId || maxWidth != wrapWidth || mode != layoutMode) {
+                layoutFontId = font->id;
+                wrapWidth = maxWidth;
+                layoutMode = mode;
+                laidOut = 0;
+                relayout = true;
             }
 
-            // Layout text
-            //--------------------------------------------------
+            if (!relayout) { return dims; }
 
-            lines.clear();
+            relayout = false;
 
-            size_t idx = 0;
-            float pos = 0;
-            
-            float x = 0;
-            float y = font->ascent;
+            // Shared layouts
+            //--------------------------------------------------
 
-            Font& fontRef = *font;
-            Line line = { "", idx, idx, x, y, 0.0f, fontRef.lineHeight };
+            bool cacheable = content.size() <= cacheableBytes;
+            Key key = { cacheable ? std::hash<std::string>{}(content) : 0, font->id, maxWidth, mode };
 
-            for (char c : content) {
+            if (cacheable) {
 
-                float charWidth = fontRef.glyphs[c].advance;
-                float newWidth = line.w + charWidth;
+                auto it = cache.find(key);
 
-                // Reset line on overflow
-                if (idx > 0 && (newWidth > maxWidth || c == '\r')) {
+                if (it != cache.end() && it->second.content == content) {
 
-                    lines.push_back(line);
+                    lines = it->second.lines;
+                    instances = it->second.instances;
+                    dims = it->second.dims;
 
-                    y += fontRef.lineHeight;
+                    laidOut = content.size();
+                    numGlyphs = instances.size();
+                    placedStart = placedEnd = 0;
 
-                    line = { "", idx, idx, x, y, charWidth, fontRef.lineHeight };
+                    return dims;
                 }
+            }
 
-                // Continue line
-                else {
-                    line.w += fontRef.glyphs[c].advance;
-                }
+            // Lay out from the line before the one edited (an edit may let a word move back up)
+            //--------------------------------------------------
 
-                line.dbg += c;
-                line.end = idx;
-                idx += 1;
+            size_t keep = 0;
+
+            if (laidOut > 0) {
+                while (keep + 1 < lines.size() && lines[keep + 1].start <= laidOut) { keep += 1; }
+                keep = (keep > 0) ? keep - 1 : 0;
             }
 
-            lines.push_back(line);
+            size_t from = keep ? lines[keep].start : 0;
+            float y = keep ? lines[keep].y : font->ascent;
+
+            instances.resize(keep ? lines[keep].first : 0);
+            lines.resize(keep);
+
+            placedEnd = std::min(placedEnd, instances.size());
+            placedStart = std::min(placedStart, placedEnd);
+
+            this->breakLines(from, y, maxWidth);
+
+            laidOut = content.size();
+            numGlyphs = instances.size();
 
             // Measure dims
             //--------------------------------------------------
@@ -273,64 +394,185 @@ export namespace Rev::Primitive {
                 dims.width = std::max(dims.width, line.w);
             }
 
+            if (cacheable) {
+                if (cache.size() >= cacheLimit) { cache.clear(); }
+                cache[key] = { content, lines, instances, dims };
+            }
+
             return dims;
         }
 
-        // Compute vertices
-        void compute() override {
+        // Break content into lines from a byte on (the start of a line), placing glyphs as we go.
+        // Lines end at newlines, and when a character would overflow the width: before it
+        // (BreakChar), or after the last space if there is one (BreakWord).
+        void breakLines(size_t idx, float y, float maxWidth) {
 
-            // Ensure font size matches
-            if (font->size != fontSize || font->scale != canvas->details.scale) {
-                delete font;
-                font = new Font(canvas, Arial_ttf, fontSize, canvas->details.scale);
-            }
+            Font& fontRef = *font;
 
-            // Prepare vertices
-            //--------------------------------------------------
+            Line line = { idx, idx, 0.0f, y, 0.0f, fontRef.lineHeight, instances.size(), 0 };
+
+            float x = 0;
+            char32_t prev = 0;
 
-            vertices->resize(content.size());
-            CharVertex* verts = (CharVertex*)vertices->data;
+            // Last place the line can break (after a space), and its width / glyphs up to there
+            size_t breakAt = 0, breakGlyphs = 0;
+            float breakWidth = 0;
 
-            data->pos = { std::round(xPos), std::round(yPos) };
+            auto next = [&](size_t start) {
 
-            float x = xPos;
-            float y = yPos + font->ascent;
-            size_t count = 0;
+                line.count = instances.size() - line.first;
+                lines.push_back(line);
 
-            for (Line& line : lines) {
+                y += fontRef.lineHeight;
+                line = { start, start, 0.0f, y, 0.0f, fontRef.lineHeight, instances.size(), 0 };
 
-                char prev = 0;
-                x = line.x; y = line.y;
+                x = 0;
+                prev = 0;
+                breakAt = 0;
+            };
 
-                for (char c : line.dbg) {
+            while (idx < content.size()) {
 
-                    // Continue / break conditions
-                    if (c < 32 || c >= 128) { continue; }
+                size_t start = idx;
+                char32_t c = Font::next(content, idx);
 
-                    Font::Glyph& glyph = font->glyphs[c];
-                    Font::Glyph& prevGlyph = font->glyphs[prev];
+                // Hard breaks (a "\r\n" pair is one)
+                if (c == '\n' || c == '\r') {
 
-                    float index = float(c);
-                    x += prevGlyph.advance + glyph.kerning[prevGlyph.index];
-                    verts[count] = {x, y, index, index };
+                    if (c == '\r' && idx < content.size() && content[idx] == '\n') { idx += 1; }
 
-                    count += 1;
-                    prev = c;
+                    line.end = idx;
+                    next(idx);
+                    continue;
                 }
+
+                Font::Glyph& glyph = fontRef.glyph(c);
+                float charWidth = glyph.advance;
+
+                // Overflow (spaces may hang off the end of a line when breaking words)
+                bool hangs = mode == WrapMode::BreakWord && c == ' ';
+                bool overflows = mode != WrapMode::None && start > line.start && !hangs && line.w + charWidth > maxWidth;
+
+                if (overflows) {
+
+                    // Move the partial word down, laying it out again on the next line
+                    if (mode == WrapMode::BreakWord && breakAt > line.start) {
+
+                        instances.resize(breakGlyphs);
+                        line.end = breakAt;
+                        line.w = breakWidth;
+
+                        idx = breakAt;
+                        next(breakAt);
+                        continue;
+                    }
+
+                    line.end = start;
+                    next(start);
+                }
+
+                x += fontRef.kern(prev, c);
+                prev = c;
+
+                // Only glyphs with something to draw get an instance
+                if (glyph.region.w) {
+                    instances.push_back({
+                        x + glyph.bearingX, y - glyph.bearingY, glyph.width, glyph.height,
+                        float(glyph.region.x), float(glyph.region.y), float(glyph.region.w), float(glyph.region.h)
+                    });
+                }
+
+                // (Trailing spaces don't count towards a broken line's width)
+                if (c == ' ') {
+                    breakWidth = line.w;
+                    breakGlyphs = instances.size();
+                    breakAt = idx;
+                }
+
+                x += charWidth;
+                line.w += charWidth;
+                line.end = idx;
+            }
+
+            // Last line (unless content ended with a newline)
+            if (line.end > line.start || lines.empty()) {
+                line.count = instances.size() - line.first;
+                lines.push_back(line);
             }
         }
 
-        // Draw vertices
+        // Compute vertices (glyphs are placed by layout, only lines which changed are placed again)
+        void compute() override {
+
+            this->layout(wrapWidth);
+
+            data->pos = { std::round(xPos), std::round(yPos) };
+        }
+
+        // Draw glyphs
         void draw() override {
         
-            pipeline->bind();
-            font->texture->bind(0);
-            font->glyphData->bind(2);
+            if (!numGlyphs) { return; }
+
+            // Only lines within the canvas (a line either side to spare), as long texts
+            // (logs etc.) are mostly scrolled or clipped away
+            float top = -data->pos.y - font->lineHeight;
+            float bottom = -data->pos.y + float(canvas->details.height) / canvas->details.scale + font->lineHeight;
+
+            auto first = std::partition_point(lines.begin(), lines.end(), [&](Line& line) { return line.y - font->ascent + line.h < top; });
+            auto last = std::partition_point(first, lines.end(), [&](Line& line) { return line.y - font->ascent < bottom; });
+
+            if (first == last) { return; }
+
+            size_t start = first->first;
+            size_t count = (last - 1)->first + (last - 1)->count - start;
+
+            if (!count) { return; }
+
+            // Newly rasterized glyphs must reach the GPU first
+            Font::atlas->upload();
 
-            vertices->bind();
-            databuff->bind(1);
+            batch->texture = Font::atlas->texture;
 
-            canvas->drawArraysInstanced(Pipeline::Topology::TriangleList, 0, 6, content.size());
+            // Records of visible glyphs not yet placed (as the arena region changes with each
+            // frame, those are copied in whole)
+            if (std::memcmp(&placedData, data, sizeof(Data))) {
+                placedData = *data;
+                placedStart = placedEnd = 0;
+            }
+
+            records.resize(instances.size());
+
+            size_t end = start + count;
+
+            if (placedStart == placedEnd || end < placedStart || start > placedEnd) {
+                this->place(start, end);
+                placedStart = start;
+                placedEnd = end;
+            }
+
+            else {
+
+                if (start < placedStart) { this->place(start, placedStart); placedStart = start; }
+                if (end > placedEnd) { this->place(placedEnd, end); placedEnd = end; }
+            }
+
+            void* arena = canvas->append(batch, count);
+            std::memcpy(arena, &records[start], count * sizeof(Record));
+        }
+
+        // Place glyphs at text position
+        void place(size_t from, size_t to) {
+
+            for (size_t i = from; i < to; i++) {
+
+                CharInstance& inst = instances[i];
+
+                records[i] = {
+                    .glyph = { inst.x + data->pos.x, inst.y + data->pos.y, inst.w, inst.h, inst.u, inst.v, inst.uw, inst.vh },
+                    .color = data->color
+                };
+            }
         }
     };
 };
\ No newline at end of file
@@ -11,10 +11,9 @@ import Rev.Core.Color;
 import Rev.Core.Vertex;
 
 import Rev.Graphics.Canvas;
-import Rev.Graphics.UniformBuffer;
-import Rev.Graphics.VertexBuffer;
 import Rev.Graphics.Pipeline;
 import Rev.Graphics.Shader;
+import Rev.Graphics.Batch;
 
 // Shader file resources
 import Resources.Shaders.OpenGL.Triangles.Triangles_vert;
@@ -29,19 +28,13 @@ export namespace Rev::Primitive {
             List, Fan, Strip
         };
 
-        // Instance-specific data
-        struct Data {
-            Color color = { 1, 1, 1, 1 };
-        };
-
         inline static Shared shared;
         inline static Pipeline* pipeline;
+        inline static Batch* batch = nullptr;
 
-        UniformBuffer* databuff = nullptr;
-        VertexBuffer* vertices = nullptr;
+        std::vector<Vertex> vertices;
 
         Topology topology;
-        Data* data = nullptr;
         bool dirty = true;
 
         Color color = { 1, 1, 1, 1 };
@@ -50,7 +43,7 @@ export namespace Rev::Primitive {
         Vertex center; std::vector<Vertex> points, left, right;
         Vertex* pCenter; std::vector<Vertex>* pPoints, *pLeft, *pRight;
 
-        size_t numFaces, numVerts;
+        size_t numFaces = 0, numVerts = 0;
 
         struct Params {
 
@@ -98,23 +91,18 @@ export namespace Rev::Primitive {
                     .openGlFrag = Triangles_frag,
                     .metalUniversal = Triangles_metal
                 });
-            });
 
-            vertices = new VertexBuffer(canvas->context, { .attribs = { 2, 4 } });
-            databuff = new UniformBuffer(canvas->context, sizeof(Data));
-            data = (Data*)databuff->data;
+                batch = new Batch(canvas->context, pipeline, { .instanced = false, .reserve = 4096, .attribs = { 2, 4 } });
+            });
         }
 
         // Destroy
         ~Triangles() {
 
-            // Destroy shared pipeline
-            shared.destroy([]() {
-                delete pipeline;
+            shared.destroy([this]() {
+                canvas->release(batch);
+                canvas->release(pipeline);
             });
-
-            delete vertices;
-            delete databuff;
         }
 
         void doFan() {
@@ -123,12 +111,12 @@ export namespace Rev::Primitive {
             std::vector<Vertex>& rPoints = *pPoints;
 
             // Calculate number of faces and vertices
-            numFaces = rPoints.size() - 1;
+            numFaces = rPoints.size() ? rPoints.size() - 1 : 0;
             numVerts = numFaces * 3;
 
-            // Resize vertex buffer to match needed vertices
-            vertices->resize(numVerts);
-            Vertex* verts = vertices->verts();
+            // Resize vertices to match needed vertices
+            vertices.resize(numVerts);
+            Vertex* verts = vertices.data();
         
             // Compute faces for triangle fan from center and perimeter (points)
             for (size_t i = 0; i < numFaces; i++) {
@@ -157,13 +145,13 @@ export namespace Rev::Primitive {
             std::vector<Vertex>& rRight = *pRight;
 
             // Calculate number of faces and vertices
-            size_t numQuads = (rLeft.size() - 1);
+            size_t numQuads = rLeft.size() ? (rLeft.size() - 1) : 0;
             numFaces = numQuads * 2;
             numVerts = numFaces * 3;
 
-            // Resize vertex buffer to match needed vertices
-            vertices->resize(numVerts);
-            Vertex* verts = vertices->verts();
+            // Resize vertices to match needed vertices
+            vertices.resize(numVerts);
+            Vertex* verts = vertices.data();
 
             for (size_t i = 0; i < numQuads; i++) {
 
@@ -199,8 +187,6 @@ export namespace Rev::Primitive {
 
         void compute() override {
 
-            data->color = color;
-
             switch (topology) {
                 case (Topology::Fan): { this->doFan(); break; }
                 case (Topology::Strip): { this->doStrip(); break; }
@@ -209,12 +195,17 @@ export namespace Rev::Primitive {
 
         void draw() override {
 
-            pipeline->bind();
+            if (!numVerts) { return; }
 
-            databuff->bind(1);
-            vertices->bind();
-            
-            canvas->drawArrays(Pipeline::Topology::TriangleList, 0, numVerts);
+            Vertex* verts = static_cast<Vertex*>(canvas->append(batch, numVerts));
+
+            for (size_t i = 0; i < numVerts; i++) {
+
+                verts[i] = vertices[i];
+
+                // Vertices without color take ours
+                if (vertices[i].color.a == 0.0f) { verts[i].color = color; }
+            }
         }
     };
 };
\ No newline at end of file
@@ -0,0 +1,188 @@
+module;
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+export module Rev.Graphics.RenderThread;
+
+export namespace Rev::Graphics {
+
+    // Frames in flight, each recorded into a slot (its packet, and its region of every arena).
+    // The canvas records a frame into a free slot and hands it off, to be submitted in order
+    // and retired (once the GPU is done with it) before the slot is recorded into again.
+    //
+    // When threaded, a render thread submits and retires slots as they come, so recording the
+    // next frame (and handling input) overlaps submitting, presenting and drawing this one.
+    // Otherwise slots are submitted as they are handed off, and retired when next acquired.
+    struct RenderThread {
+
+        // One being recorded, one queued, one being drawn
+        static constexpr size_t slots = 3;
+
+        // Draw the frame recorded into a slot
+        std::function<void(size_t)> submit;
+
+        // Wait for the GPU to be done with a slot, then free what its frame held onto
+        std::function<void(size_t)> retire;
+
+        bool threaded = false;
+
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable changed;
+
+        std::deque<size_t> queue;               // Slots handed off, in order
+        std::array<bool, slots> held = {};      // Slots handed off and not yet retired
+        std::function<void()> teardown;
+        bool stopping = false;
+
+        // Slot to record into next
+        size_t next = 0;
+
+        // First failure of the render thread (passed on to the recording side)
+        std::exception_ptr error;
+
+        // Start (with setup run where slots will be submitted)
+        void start(bool threaded, std::function<void()> setup) {
+
+            this->threaded = threaded;
+
+            if (!threaded) { return setup(); }
+
+            thread = std::thread([this, setup]() {
+                this->guard(setup);
+                this->run();
+            });
+        }
+
+        // Stop, once everything handed off is done (teardown is run where setup was)
+        void stop(std::function<void()> onStop) {
+
+            if (!threaded) {
+                this->finish();
+                return onStop();
+            }
+
+            // (Failures go unreported, as we're likely being destroyed)
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]() { return queue.empty(); });
+
+                teardown = onStop;
+                stopping = true;
+            }
+
+            changed.notify_all();
+            thread.join();
+
+            threaded = false;
+        }
+
+        // Recording side
+        //--------------------------------------------------
+
+        // Get the next slot to record into, waiting until its last frame is retired
+        size_t acquire() {
+
+            size_t slot = next;
+            next = (next + 1) % slots;
+
+            if (!threaded) {
+                retire(slot);
+                return slot;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return !held[slot] || error; });
+
+            this->rethrow();
+
+            return slot;
+        }
+
+        // Hand off a recorded slot
+        void push(size_t slot) {
+
+            if (!threaded) { return submit(slot); }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                held[slot] = true;
+                queue.push_back(slot);
+            }
+
+            changed.notify_all();
+        }
+
+        // Wait until every slot is retired (so nothing a frame drew with is still in use)
+        void finish() {
+
+            // Oldest first, as later frames may have replaced what earlier ones drew with
+            if (!threaded) {
+                for (size_t i = 0; i < slots; i++) { retire((next + i) % slots); }
+                return;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return queue.empty() || error; });
+
+            this->rethrow();
+        }
+
+        // Render thread
+        //--------------------------------------------------
+
+        void run() {
+
+            std::unique_lock<std::mutex> lock(mutex);
+
+            while (true) {
+
+                changed.wait(lock, [&]() { return !queue.empty() || stopping; });
+
+                if (queue.empty()) { break; }
+
+                size_t slot = queue.front();
+
+                lock.unlock();
+                this->guard([&]() { submit(slot); retire(slot); });
+                lock.lock();
+
+                queue.pop_front();
+                held[slot] = false;
+
+                changed.notify_all();
+            }
+
+            lock.unlock();
+            this->guard(teardown);
+        }
+
+        // Keep the first failure, to be thrown by the recording side
+        void guard(const std::function<void()>& work) {
+
+            try { work(); }
+
+            catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) { error = std::current_exception(); }
+            }
+        }
+
+        void rethrow() {
+
+            if (!error) { return; }
+
+            std::exception_ptr thrown = error;
+            error = nullptr;
+
+            std::rethrow_exception(thrown);
+        }
+    };
+};
@@ -0,0 +1,62 @@
+module;
+
+#include <vector>
+#include <algorithm>
+
+export module Rev.Application;
+
+import Rev.NativeWindow;
+import Rev.Element.Window;
+
+export namespace Rev {
+
+    using namespace Rev::Element;
+
+    struct Application {
+
+        std::vector<Window*> windows;
+
+        // Create
+        Application() {
+
+        }
+
+        // Destroy
+        ~Application() {
+            for (Window* w : windows) { delete w; }
+        }
+
+        // Paint windows until none wants another frame (with no events to wait on,
+        // there is nothing more to do after that)
+        void run() {
+
+            bool painted = true;
+
+            while (!windows.empty() && painted) {
+
+                painted = false;
+
+                for (Window* w : windows) {
+                    if (w->window->dirty) { w->window->paint(); painted = true; }
+                }
+
+                // Cleanup closed windows
+                for (auto it = windows.begin(); it != windows.end();) {
+                    if ((*it)->shouldClose) { delete *it; it = windows.erase(it); }
+                    else { ++it; }
+                }
+            }
+        }
+
+        // Remove window from our list
+        void removeWindow(Window* target) {
+
+            auto it = std::find(windows.begin(), windows.end(), target);
+
+            if (it != windows.end()) {
+                delete *it;
+                windows.erase(it);
+            }
+        }
+    };
+}
@@ -0,0 +1,105 @@
+module;
+
+#include <cstdint>
+#include <functional>
+#include "../WinEvent.hpp"
+
+export module Rev.NativeWindow;
+
+import Rev.NativeKey;
+
+export namespace Rev {
+
+    // A window with nowhere to be shown: it has a size and scale like any other, events
+    // are fed to it by hand, and frames are painted when the application gets to them
+    struct NativeWindow {
+
+
+        enum ButtonAction {
+            Release, Press, DoubleClick
+        };
+
+        enum MouseButton {
+            Left, Right, Middle
+        };
+
+        // Keycode mapping
+        //--------------------------------------------------
+        
+        using Key = Rev::Key;
+
+        const char* keyToString(int key) { return Rev::keyToString(Key(key)); }
+        const char* keyToString(Key key) { return Rev::keyToString(key); }
+
+        struct Size {
+            int w, h, minW, minH, maxW, maxH;
+        };
+
+        using EventCallback = std::function<void(WinEvent&)>;
+
+        void* handle = nullptr;
+        EventCallback callback;
+
+        Size size;
+        float scale = 1.0f;
+        bool dirty = false;
+
+        // Create
+        NativeWindow(void* parent,
+                     Size size = {600, 400, 0, 0, 1000, 1000},
+                     EventCallback callback = nullptr) {
+
+            this->handle = this;
+            this->size = size;
+            this->callback = callback;
+
+            // Paint once to begin with
+            dirty = true;
+        }
+
+        // Destroy
+        ~NativeWindow() {
+
+        }
+
+        // Methods
+        //--------------------------------------------------
+
+        void setSize(int w, int h) {
+
+            size.w = w;
+            size.h = h;
+
+            this->notifyEvent({ .type = WinEvent::Resize, .c = w, .d = h });
+        }
+
+        void setScale(float newScale) {
+
+            scale = newScale;
+
+            this->notifyEvent({ .type = WinEvent::Scale });
+        }
+
+        void requestFrame() {
+            dirty = true;
+        }
+
+        // Paint now (the window clears dirty once drawn)
+        void paint() {
+            this->notifyEvent({ .type = WinEvent::Paint });
+        }
+
+        WinEvent notifyEvent(WinEvent event) {
+            if (callback) { callback(event); }
+            return event;
+        }
+
+        void makeContextCurrent() {};
+        void loadGlFunctions() {};
+        void swapBuffers() {};
+
+        void* createSharedContext() { return nullptr; };
+        void useContext(void* context) {};
+        void destroyContext(void* context) {};
+    };
+}
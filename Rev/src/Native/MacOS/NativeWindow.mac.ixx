@@ -8,6 +8,8 @@ module;
 
 export module Rev.NativeWindow;
 
+import Rev.NativeKey;
+
 export namespace Rev {
 
     struct NativeWindow {
@@ -15,28 +17,10 @@ export namespace Rev {
         enum ButtonAction { Release, Press, DoubleClick };
         enum MouseButton { Left, Right, Middle };
 
-        enum class Key {
-            Unknown,
-            Ctrl, Shift, Alt, Super,
-            Up, Down, Left, Right,
-            PageUp, PageDown, Home, End, Insert, Delete,
-            F1, F2, F3, F4, F5, F6,
-            F7, F8, F9, F10, F11, F12,
-            Num0, Num1, Num2, Num3, Num4,
-            Num5, Num6, Num7, Num8, Num9,
-            A, B, C, D, E, F, G, H, I, J,
-            K, L, M, N, O, P, Q, R, S, T,
-            U, V, W, X, Y, Z,
-            Numpad0, Numpad1, Numpad2, Numpad3, Numpad4,
-            Numpad5, Numpad6, Numpad7, Numpad8, Numpad9,
-            NumpadAdd, NumpadSub, NumpadMul, NumpadDiv, NumpadEnter, NumpadDecimal,
-            Escape, Space, Tab, Enter, Backspace,
-            CapsLock, NumLock, ScrollLock,
-            PrintScreen, Pause,
-        };
+        using Key = Rev::Key;
 
-        const char* keyToString(int key) { return keyToString(Key(key)); }
-        const char* keyToString(Key key) { }
+        const char* keyToString(int key) { return Rev::keyToString(Key(key)); }
+        const char* keyToString(Key key) { return Rev::keyToString(key); }
 
         struct Size { int w, h, minW, minH, maxW, maxH; };
 
@@ -77,6 +61,10 @@ export namespace Rev {
         void loadGlFunctions() {};
         void swapBuffers() {};
 
+        void* createSharedContext() { return nullptr; };
+        void useContext(void* context) {};
+        void destroyContext(void* context) {};
+
         Size size;
         float scale = 1.0f;
         bool dirty = false;
@@ -18,6 +18,8 @@ module;
 
 export module Rev.NativeWindow;
 
+import Rev.NativeKey;
+
 export namespace Rev {
 
     struct NativeWindow {
@@ -33,40 +35,7 @@ export namespace Rev {
         // Keycode mapping
         //--------------------------------------------------
         
-        // Unified key enum
-        enum class Key : int {
-            
-            Unknown,
-
-            Ctrl, Shift, Alt, Super,
-
-            // Navigation
-            Up, Down, Left, Right,
-            PageUp, PageDown, Home, End, Insert, Delete,
-
-            // Function keys
-            F1, F2, F3, F4, F5, F6,
-            F7, F8, F9, F10, F11, F12,
-
-            // Numbers (top row)
-            Num0, Num1, Num2, Num3, Num4,
-            Num5, Num6, Num7, Num8, Num9,
-
-            // Letters
-            A, B, C, D, E, F, G, H, I, J,
-            K, L, M, N, O, P, Q, R, S, T,
-            U, V, W, X, Y, Z,
-
-            // Numpad
-            Numpad0, Numpad1, Numpad2, Numpad3, Numpad4,
-            Numpad5, Numpad6, Numpad7, Numpad8, Numpad9,
-            NumpadAdd, NumpadSub, NumpadMul, NumpadDiv, NumpadEnter, NumpadDecimal,
-
-            // Misc
-            Escape, Space, Tab, Enter, Backspace,
-            CapsLock, NumLock, ScrollLock,
-            PrintScreen, Pause,
-        };
+        using Key = Rev::Key;
 
         // Win32 keycode -> key enum map
         inline static const std::unordered_map<int, Key> WinKeys = {
@@ -120,62 +89,8 @@ export namespace Rev {
             { VK_PAUSE,     Key::Pause },
         };
 
-        const char* keyToString(int key) { return keyToString(Key(key)); }
-        const char* keyToString(Key key) {
-
-            switch (key) {
-
-                case Key::Ctrl:   return "Ctrl";
-                case Key::Shift:  return "Shift";
-                case Key::Alt:    return "Alt";
-                case Key::Super:  return "Super";
-        
-                case Key::Up:    return "Up";
-                case Key::Down:  return "Down";
-                case Key::Left:  return "Left";
-                case Key::Right: return "Right";
-        
-                case Key::PageUp:   return "PageUp";
-                case Key::PageDown: return "PageDown";
-                case Key::Home:     return "Home";
-                case Key::End:      return "End";
-                case Key::Insert:   return "Insert";
-                case Key::Delete:   return "Delete";
-        
-                case Key::F1:  return "F1";
-                case Key::F2:  return "F2";
-                case Key::F3:  return "F3";
-                case Key::F4:  return "F4";
-                case Key::F5:  return "F5";
-                case Key::F6:  return "F6";
-                case Key::F7:  return "F7";
-                case Key::F8:  return "F8";
-                case Key::F9:  return "F9";
-                case Key::F10: return "F10";
-                case Key::F11: return "F11";
-                case Key::F12: return "F12";
-        
-                case Key::A: return "A";
-                case Key::B: return "B";
-                case Key::C: return "C";
-                // … repeat for all alphas/numbers …
-        
-                case Key::Escape:    return "Escape";
-                case Key::Space:     return "Space";
-                case Key::Tab:       return "Tab";
-                case Key::Enter:     return "Enter";
-                case Key::Backspace: return "Backspace";
-        
-                case Key::CapsLock:  return "CapsLock";
-                case Key::NumLock:   return "NumLock";
-                case Key::ScrollLock:return "ScrollLock";
-        
-                case Key::PrintScreen: return "PrintScreen";
-                case Key::Pause:       return "Pause";
-        
-                default: return "Unknown";
-            }
-        }
+        const char* keyToString(int key) { return Rev::keyToString(Key(key)); }
+        const char* keyToString(Key key) { return Rev::keyToString(key); }
 
         struct Size {
             int w, h, minW, minH, maxW, maxH;
@@ -597,6 +512,11 @@ export namespace Rev {
         typedef BOOL  (WINAPI *PFNWGLCHOOSEPIXELFORMATARBPROC)(HDC, const int*, const FLOAT*, UINT, int*, UINT*);
         typedef BOOL  (WINAPI *PFNWGLSWAPINTERVALEXTPROC)(int);
 
+        // Kept to create shared contexts like the window's
+        PFNWGLCREATECONTEXTATTRIBSARBPROC createContextAttribs = nullptr;
+        PFNWGLSWAPINTERVALEXTPROC swapInterval = nullptr;
+        int contextVersion[2] = { 0, 0 };
+
         static ATOM registerDummyClass(HINSTANCE inst, LPCWSTR name, WNDPROC wndproc) {
 
             WNDCLASSW wc = {
@@ -776,7 +696,7 @@ export namespace Rev {
                 };
 
                 realRC = wglCreateContextAttribsARB(hdc, 0, ctxAttribs);
-                if (realRC) { break; }
+                if (realRC) { contextVersion[0] = v[0]; contextVersion[1] = v[1]; break; }
             }
 
             if (!realRC) {
@@ -803,12 +723,52 @@ export namespace Rev {
 
             hglrc = realRC;
 
+            createContextAttribs = wglCreateContextAttribsARB;
+            swapInterval = wglSwapIntervalEXT;
+
             // Optional: enable vsync if extension is present
             if (wglSwapIntervalEXT) {
                 wglSwapIntervalEXT(1); // 1 = vsync on, 0 = off
             }
         }
 
+        // Another context sharing objects (buffers, textures, programs, syncs) with the
+        // window's, for drawing to the window from another thread
+        void* createSharedContext() {
+
+            if (!hglrc) { throw std::runtime_error("[NativeWindow] No context to share with"); }
+
+            int ctxAttribs[] = {
+                0x2091 /*WGL_CONTEXT_MAJOR_VERSION_ARB*/, contextVersion[0],
+                0x2092 /*WGL_CONTEXT_MINOR_VERSION_ARB*/, contextVersion[1],
+                0x9126 /*WGL_CONTEXT_PROFILE_MASK_ARB*/,  0x00000001 /*WGL_CONTEXT_CORE_PROFILE_BIT_ARB*/,
+                0
+            };
+
+            HGLRC sharedRC = createContextAttribs(hdc, hglrc, ctxAttribs);
+
+            if (!sharedRC) { throw std::runtime_error("[NativeWindow] Failed to create shared GL context"); }
+
+            return sharedRC;
+        }
+
+        // Make a context current on the calling thread (or none, with nullptr)
+        void useContext(void* context) {
+
+            if (!wglMakeCurrent(context ? hdc : nullptr, static_cast<HGLRC>(context))) {
+                throw std::runtime_error("[NativeWindow] wglMakeCurrent (shared) failed");
+            }
+
+            // (Swap interval is per context)
+            if (context && swapInterval) {
+                swapInterval(1);
+            }
+        }
+
+        void destroyContext(void* context) {
+            if (context) { wglDeleteContext(static_cast<HGLRC>(context)); }
+        }
+
         void swapBuffers() {
             if (hdc) {
                 SwapBuffers(hdc);
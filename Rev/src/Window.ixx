@@ -1,7 +1,10 @@
 module;
 
+#include <span>
+#include <chrono>
 #include <vector>
 #include <string>
+#include <algorithm>
 #include <codecvt>
 #include <locale>
 #include <dbg.hpp>
@@ -11,11 +14,13 @@ module;
 export module Rev.Element.Window;
 
 import Rev.Core.Pos;
+import Rev.Core.Rect;
 
 import Rev.Element;
 import Rev.Element.Box;
 import Rev.Element.Style;
 import Rev.Element.Event;
+import Rev.Element.HitGrid;
 
 import Rev.NativeWindow;
 import Rev.Graphics.Canvas;
@@ -35,6 +40,12 @@ export namespace Rev::Element {
             bool decorated = true;
             bool resizable = true;
 
+            // Only recompute dirty elements/subtrees (otherwise everything, every frame)
+            bool incremental = true;
+
+            // Submit frames from a render thread, while the next one is laid out and recorded
+            bool pipelined = false;
+
             Details() {
 
             }
@@ -109,7 +120,7 @@ export namespace Rev::Element {
             // Canvas
             //--------------------------------------------------
 
-            shared->canvas = new Graphics::Canvas(window);
+            shared->canvas = new Graphics::Canvas(window, details.pipelined);
             event.canvas = shared->canvas;
 
             // Children
@@ -156,8 +167,12 @@ export namespace Rev::Element {
         // Destroy
         ~Window() {
 
+            // Children first, their primitives may wait on frames in flight
+            this->deleteChildren();
+
             delete shared->canvas;
             delete shared;
+            shared = nullptr;
 
             delete window;
         }
@@ -173,12 +188,15 @@ export namespace Rev::Element {
         // Calculate top-down call order
         void calcTopDownQueue(Element* element, size_t depth = 0) {
 
+            element->topDownIndex = topDown.size();
             topDown.push_back(element);
             element->depth = depth;
         
             for (Element* child : element->children) {
                 calcTopDownQueue(child, depth + 1);
             }
+
+            element->descendants = topDown.size() - element->topDownIndex - 1;
         }
 
         // Calculate bottom-up call order
@@ -188,15 +206,37 @@ export namespace Rev::Element {
                 calcBottomUpQueue(child);
             }
 
+            element->bottomUpIndex = bottomUp.size();
             bottomUp.push_back(element);
         }
 
-        // Calculate top-down / bottom-up call orders
+        // Calculate top-down / bottom-up call orders (only when the tree has changed)
         void calculateQueues() {
 
+            if (!shared->structureDirty) { return; }
+
             topDown.clear(); bottomUp.clear();
             this->calcTopDownQueue(this);
             this->calcBottomUpQueue(this);
+
+            shared->structureDirty = false;
+        }
+
+        // A subtree is contiguous in both queues
+        std::span<Element*> topDownOf(Element* element) {
+            return std::span(topDown).subspan(element->topDownIndex, element->descendants + 1);
+        }
+
+        std::span<Element*> bottomUpOf(Element* element) {
+            return std::span(bottomUp).subspan(element->bottomUpIndex - element->descendants, element->descendants + 1);
+        }
+
+        // Whether element lies within the subtree of root
+        bool within(Element* element, Element* root) {
+            return (
+                element->topDownIndex >= root->topDownIndex &&
+                element->topDownIndex <= root->topDownIndex + root->descendants
+            );
         }
 
         // Top-level only
@@ -217,6 +257,237 @@ export namespace Rev::Element {
 
             // Final step is to resolve rects (which includes alignment)
             for (Element* element: topDown) { element->resolveRects(); }
+
+            stats.laidOut += topDown.size();
+        }
+
+        // Re-layout a single subtree, as long as the result doesn't concern its parent.
+        // Returns false (and leaves the subtree half-resolved) if the parent must re-layout too.
+        bool calcSubtreeLayout(Element* root) {
+
+            std::span<Element*> down = topDownOf(root);
+            std::span<Element*> up = bottomUpOf(root);
+
+            // The root's parent decides its final size/position, which we keep
+            Rect rootRect = root->rect;
+
+            for (Element* element : down) { element->resetLayout(); }
+
+            // Resolve dimensions necessary to layout (root resolves against what its parent saw)
+            for (Element* element : down) { element->resolveAbs(); }
+            for (Element* element : down) {
+                if (element == root) { element->resolveRel(root->parent->relRes); }
+                else { element->resolveRel(); }
+            }
+            for (Element* element : up) { element->resolveMinima(); }
+            for (Element* element : up) { element->resolveLayout(); }
+
+            // Promote all but the root (root would promote into its parent)
+            for (Element* element : up.first(up.size() - 1)) { element->promoteFlexDims(); }
+
+            stats.laidOut += down.size();
+
+            // If the root looks any different to its parent, the parent must re-layout
+            if (!root->res.same(root->promotedRes)) {
+                return false;
+            }
+
+            // Restore what the parent gave us last time
+            root->res = root->grownRes;
+            root->rect = rootRect;
+
+            // Resolve flex dims and distribute space post-layout
+            for (Element* element : down) { element->resolveFlexDims(); }
+            for (Element* element : up) { element->remeasureLayout(); }
+
+            // (The parent clamps us while resolving rects)
+            root->res.size.clamp();
+
+            for (Element* element : down) { element->resolveRects(); }
+
+            return true;
+        }
+
+        // Re-layout from root, climbing towards the window until the change is contained
+        Element* calcLayoutFrom(Element* root) {
+
+            while (root != this) {
+                if (calcSubtreeLayout(root)) { return root; }
+                root = root->parent;
+            }
+
+            this->calcFlexLayouts();
+
+            return this;
+        }
+
+        // Recomputing
+        //--------------------------------------------------
+
+        struct FrameStats {
+            size_t styled = 0;      // Elements whose style was computed
+            size_t laidOut = 0;     // Elements which went through layout
+            size_t computed = 0;    // Elements whose primitives were computed
+            size_t recomputed = 0;  // Elements touched by any of the above
+            size_t drawCalls = 0;   // Draw calls issued by the canvas
+            size_t stateBinds = 0;  // Pipeline / buffer / texture binds by the canvas
+            size_t animated = 0;    // Elements moved along by animations
+
+            // Time spent per phase (milliseconds)
+            double styleMs = 0;
+            double layoutMs = 0;
+            double computeMs = 0;
+            double submitMs = 0;    // Drawing, from beginning to end of canvas frame
+        };
+
+        FrameStats stats;
+        size_t frames = 0;
+
+        using Clock = std::chrono::steady_clock;
+
+        // Milliseconds since a point in time (and move it to now)
+        static double lap(Clock::time_point& since) {
+
+            Clock::time_point now = Clock::now();
+            double ms = std::chrono::duration<double, std::milli>(now - since).count();
+            since = now;
+
+            return ms;
+        }
+
+        // Recompute every element
+        void computeAll(Event& e) {
+
+            Clock::time_point time = Clock::now();
+
+            for (Element* element : topDown) { element->computeStyle(e); }
+            stats.styleMs = lap(time);
+         
+            this->calcFlexLayouts();
+            stats.layoutMs = lap(time);
+
+            for (Element* element : topDown) {
+                element->computePrimitives(e);
+                element->computedRect = element->rect;
+                element->computedFrame = frames;
+            }
+
+            stats.computeMs = lap(time);
+
+            hitGrid.rebuild(topDown);
+
+            stats.styled = stats.computed = stats.recomputed = topDown.size();
+        }
+
+        // Recompute dirty elements, re-layout only the subtrees they affect
+        void computeDirty(Event& e) {
+
+            std::vector<Element*>& dirtyElements = shared->dirtyElements;
+            Clock::time_point time = Clock::now();
+
+            // Style
+            //--------------------------------------------------
+
+            std::vector<Element*> layoutRoots;
+
+            // We always compute our own style, since it follows the native window
+            // (refreshing us never adds us to the dirty elements)
+            dirtyElements.push_back(this);
+
+            // Elements may dirty others while computing style (so no range-for)
+            for (size_t i = 0; i < dirtyElements.size(); i++) {
+
+                Element* element = dirtyElements[i];
+
+                Style old = element->computed.style;
+                element->computeStyle(e);
+                stats.styled += 1;
+
+                // Layout change means our parent must place us again
+                if (!element->computed.style.sameLayout(old)) {
+                    layoutRoots.push_back(element == this ? this : element->parent);
+                }
+
+                // Measured content (text) may need another size with the same style
+                else if (element->measure) {
+                    layoutRoots.push_back(element);
+                }
+            }
+
+            // Animations already moved values along (only layout-affecting ones need layout)
+            for (void* owner : shared->animator.laidOut) {
+                Element* element = static_cast<Element*>(owner);
+                layoutRoots.push_back(element == this ? this : element->parent);
+            }
+
+            stats.styleMs = lap(time);
+
+            // Layout
+            //--------------------------------------------------
+
+            // Outermost roots first, so nested ones can be skipped
+            std::sort(layoutRoots.begin(), layoutRoots.end(), [](Element* a, Element* b) {
+                return a->topDownIndex < b->topDownIndex;
+            });
+
+            std::vector<Element*> laidOut;
+
+            for (Element* root : layoutRoots) {
+
+                bool covered = std::any_of(laidOut.begin(), laidOut.end(), [&](Element* done) {
+                    return this->within(root, done);
+                });
+
+                if (!covered) { laidOut.push_back(this->calcLayoutFrom(root)); }
+            }
+
+            stats.layoutMs = lap(time);
+
+            // Primitives
+            //--------------------------------------------------
+
+            std::vector<Element*> compute;
+
+            auto enqueue = [&](Element* element) {
+                if (element->computedFrame == frames) { return; }
+                element->computedFrame = frames;
+                compute.push_back(element);
+            };
+
+            for (Element* element : dirtyElements) { enqueue(element); }
+            for (void* owner : shared->animator.painted) { enqueue(static_cast<Element*>(owner)); }
+
+            // Anything that moved or resized
+            for (Element* root : laidOut) {
+                for (Element* element : topDownOf(root)) {
+                    if (!(element->rect == element->computedRect)) { enqueue(element); }
+                }
+            }
+
+            std::sort(compute.begin(), compute.end(), [](Element* a, Element* b) {
+                return a->topDownIndex < b->topDownIndex;
+            });
+
+            for (Element* element : compute) {
+                element->computePrimitives(e);
+                element->computedRect = element->rect;
+            }
+
+            // (In top-down order, so parents are placed before their children)
+            for (Element* element : compute) { hitGrid.update(element, topDown); }
+
+            stats.computed = compute.size();
+            stats.computeMs = lap(time);
+
+            // Count each element once
+            for (Element* root : laidOut) { stats.recomputed += root->descendants + 1; }
+
+            for (Element* element : compute) {
+                bool counted = std::any_of(laidOut.begin(), laidOut.end(), [&](Element* root) {
+                    return this->within(element, root);
+                });
+                if (!counted) { stats.recomputed += 1; }
+            }
         }
 
         // Draw
@@ -236,23 +507,30 @@ export namespace Rev::Element {
 
             dbg("Drawing");
 
-            this->dirty = false;
-
             event.resetBeforeDispatch();
-            shared->dirtyElements.clear();
+            this->forgetDeleted();
+
+            frames += 1;
+            stats = FrameStats();
+
+            bool structureDirty = shared->structureDirty;
+
+            // Move animations along (values land in computed styles directly)
+            shared->animator.advance(e.time);
+            stats.animated = shared->animator.painted.size();
 
             this->calculateQueues();
             this->stencilStack.clear();
 
-            for (Element* element : topDown) { element->computeStyle(e); }
-         
-            this->calcFlexLayouts();
-
-            for (Element* element : topDown) { element->computePrimitives(e); }
+            // Recompute elements
+            if (details.incremental && !structureDirty) { this->computeDirty(e); }
+            else { this->computeAll(e); }
 
+            this->dirty = false;
             shared->dirtyElements.clear();
 
             Graphics::Canvas& canvas = *shared->canvas;
+            Clock::time_point time = Clock::now();
 
             canvas.beginFrame();
 
@@ -324,12 +602,21 @@ export namespace Rev::Element {
             //--------------------------------------------------
 
             shared->canvas->endFrame();
+            stats.submitMs = lap(time);
+
+            stats.drawCalls = canvas.stats.drawCalls;
+            stats.stateBinds = canvas.stats.stateBinds;
 
             window->dirty = false;
 
             if (this->dirty) {
                 refresh(e);
             }
+
+            // Animations continue next frame
+            if (!shared->animator.empty()) {
+                window->requestFrame();
+            }
         }
 
         // Controlling window
@@ -359,22 +646,54 @@ export namespace Rev::Element {
         // Responding to window events
         //--------------------------------------------------
 
-        // We set targets from the bottom up, then dispatching the event from top down
+        // Elements under the cursor, and those plus their ancestors (the hit path)
+        HitGrid hitGrid;
+        std::vector<Element*> hits;
+        std::vector<Element*> hitPath;
+
+        // We set targets along the hit path, then dispatch the event from top down
+        // (only into children which were hit)
         void setTargets(Event& e) {
 
-            for (Element* element : topDown) {
+            this->forgetDeleted();
+
+            for (Element* element : hitPath) {
                 element->targetFlags.hit = false;
             }
 
-            for (Element* element : bottomUp) {
-                
-                Element& elem = *element;
+            hitPath.clear();
+            hitGrid.query(e.mouse.pos, hits);
+
+            // Mark each hit and its ancestors, until reaching one already marked
+            for (Element* element : hits) {
+
+                while (!element->targetFlags.hit) {
 
-                if (elem.contains(e.mouse.pos)) { elem.targetFlags.hit = true; }
-                if (elem.targetFlags.hit) { elem.parent->targetFlags.hit = true; }
+                    element->targetFlags.hit = true;
+                    hitPath.push_back(element);
+
+                    if (element == this) { break; }
+                    element = element->parent;
+                }
             }
         }
 
+        // Elements deleted since the last event or frame (e.g. by handlers) must not be hit, nor have
+        // their flags reset. Only their addresses are compared, as they're gone.
+        void forgetDeleted() {
+
+            std::vector<Element*>& gone = shared->deletedElements;
+            if (gone.empty()) { return; }
+
+            auto deleted = [&](Element* element) { return std::find(gone.begin(), gone.end(), element) != gone.end(); };
+
+            std::erase_if(hitPath, deleted);
+            std::erase_if(hits, deleted);
+            hitGrid.forget(gone);
+
+            gone.clear();
+        }
+
         virtual void onEvent(WinEvent& event) {
 
             if (event.subject) {
@@ -475,6 +794,15 @@ export namespace Rev::Element {
 
             details.width = window->size.w / scale;
             details.height = window->size.h / scale;
+
+            if (!shared) { return; }
+            if (!shared->canvas) { return; }
+
+            shared->canvas->flags.resize = true;
+
+            // Fonts and stroke widths follow the scale, so every element is recomputed
+            // (even those whose logical rect stays the same)
+            for (Element* element : topDown) { element->refresh(event); }
         }
 
         // Mouse/keyboard callbacks (window only)
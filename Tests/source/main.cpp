@@ -0,0 +1,468 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "Graphics/Primitives/Lines/TriangulatePolyline.hpp"
+
+import Rev.Application;
+import Rev.Core.Font;
+import Rev.Element;
+import Rev.Element.Style;
+import Rev.Element.Animator;
+import Rev.Element.Box;
+import Rev.Element.TextBox;
+import Rev.Element.Window;
+
+using namespace Rev;
+using namespace Rev::Element;
+
+// Checks run on the headless canvas, by ctest (exiting with 1 if any fail)
+//
+//   RevTests [name]
+
+// Failed checks of the test running
+size_t failures = 0;
+
+void check(bool passed, const char* what) {
+
+    if (passed) { return; }
+
+    std::printf("  failed: %s\n", what);
+    failures += 1;
+}
+
+// Animations
+//--------------------------------------------------
+
+// Delete elements (a subtree and its root) while their transitions run, their tracks must
+// go with them rather than be written to afterwards
+void deleteWhileAnimating() {
+
+    Application* application = new Application();
+    Window* window = new Window(application->windows, Window::Details());
+
+    Animator& animator = window->shared->animator;
+
+    Box* outer = new Box(window);
+    Box* inner = new Box(outer);
+    Box* other = new Box(window);
+
+    for (Box* box : { outer, inner, other }) {
+        box->style = {
+            .size = { .width = 100_px, .height = 100_px, .transition = 60000 },
+            .background = { .color = rgba(255, 255, 255, 1.0), .transition = 60000 }
+        };
+    }
+
+    window->window->paint();
+
+    // Head somewhere else, slowly
+    for (Box* box : { outer, inner, other }) {
+        box->style->size.width = 200_px;
+        box->style->background.color = rgba(0, 0, 0, 1.0);
+        box->refresh(*window->shared->event);
+    }
+
+    window->window->paint();
+
+    check(animator.counts.contains(outer) && animator.counts.contains(inner), "transitions started");
+
+    void* gone[] = { outer, inner };
+    delete outer;
+
+    for (void* owner : gone) {
+        check(!animator.counts.contains(owner), "no tracks left for deleted elements");
+        check(std::find(animator.owners.begin(), animator.owners.end(), owner) == animator.owners.end(), "no tracks owned by deleted elements");
+    }
+
+    check(window->children.size() == 1, "deleted element left its parent");
+
+    // Next frame only moves what's left along
+    window->window->paint();
+
+    for (void* owner : gone) {
+        check(std::find(animator.painted.begin(), animator.painted.end(), owner) == animator.painted.end(), "deleted elements not recomputed");
+    }
+
+    check(animator.counts.contains(other), "others keep animating");
+
+    delete application;
+}
+
+// Drawing
+//--------------------------------------------------
+
+// Delete the last text and box while frames drawn with them are in flight (pipelined), their
+// shared batches and pipelines must be kept until those frames are done with them
+void releaseInFlight() {
+
+    Window::Details details;
+    details.pipelined = true;
+
+    Application* application = new Application();
+    Window* window = new Window(application->windows, details);
+
+    Box* box = new Box(window);
+    box->style = {
+        .size = { .width = 100_px, .height = 100_px },
+        .background = { .color = rgba(255, 0, 0, 1.0) }
+    };
+
+    new TextBox(box, "In flight");
+
+    window->window->paint();
+    window->window->paint();
+
+    delete box;
+
+    window->window->paint();
+    window->window->paint();
+
+    check(window->children.empty(), "deleted along with its text");
+
+    delete application;
+}
+
+// Hit testing
+//--------------------------------------------------
+
+// Delete an element under the cursor before the next frame (as a close button's handler
+// would), the next event must neither hit it nor reset its flags
+void deleteUnderCursor() {
+
+    Application* application = new Application();
+    Window* window = new Window(application->windows, Window::Details());
+
+    Box* doomed = new Box(window);
+    Box* other = new Box(window);
+
+    for (Box* box : { doomed, other }) {
+        box->style = { .size = { .width = 100_px, .height = 100_px } };
+    }
+
+    window->window->paint();
+    window->onCursorPos(50, 50);
+
+    check(std::find(window->hitPath.begin(), window->hitPath.end(), doomed) != window->hitPath.end(), "hit before deleting");
+
+    void* gone = doomed;
+    delete doomed;
+
+    window->onCursorPos(60, 60);
+
+    check(std::find(window->hitPath.begin(), window->hitPath.end(), gone) == window->hitPath.end(), "not hit once deleted");
+
+    for (auto& cell : window->hitGrid.cells) {
+        check(std::find(cell.begin(), cell.end(), gone) == cell.end(), "gone from the grid");
+    }
+
+    // Once laid out again, what took its place is hit
+    window->window->paint();
+    window->onCursorPos(50, 50);
+
+    check(other->targetFlags.hit, "others are hit in its place");
+
+    delete application;
+}
+
+// Text
+//--------------------------------------------------
+
+// Text boxes wrap to the width their parent leaves them, and lay out again when it changes
+void textBoxWraps() {
+
+    Application* application = new Application();
+    Window* window = new Window(application->windows, Window::Details());
+
+    Box* column = new Box(window);
+    column->style = { .size = { .width = 120_px } };
+
+    TextBox* textBox = new TextBox(column, "The quick brown fox jumps over the lazy dog, again and again");
+    textBox->text->mode = Text::WrapMode::BreakWord;
+    textBox->refresh(*window->shared->event);
+
+    window->window->paint();
+
+    check(textBox->text->lines.size() > 1, "wraps in a narrow parent");
+    check(textBox->rect.w <= 120.0f, "fits its parent");
+    check(textBox->rect.h == textBox->text->dims.height, "takes the wrapped height");
+
+    column->style->size.width = 2000_px;
+    column->refresh(*window->shared->event);
+
+    window->window->paint();
+
+    check(textBox->text->lines.size() == 1, "unwraps once there's room");
+    check(textBox->rect.w == textBox->text->dims.width, "takes the unwrapped width");
+
+    delete application;
+}
+
+// Glyphs taking a freed region leave the rest of it to others, rather than the atlas growing
+void atlasReuse() {
+
+    using Region = Core::Atlas::Region;
+
+    Core::Atlas atlas(nullptr);
+
+    Region freed = atlas.allocate(64, 64);
+    size_t penX = atlas.penX, penY = atlas.penY;
+
+    atlas.free(freed);
+
+    // 4 by 4 fit, with padding between them
+    std::vector<Region> regions;
+    for (size_t i = 0; i < 16; i++) { regions.push_back(atlas.allocate(12, 12)); }
+
+    check(atlas.penX == penX && atlas.penY == penY, "all taken from the freed region");
+
+    for (size_t i = 0; i < regions.size(); i++) {
+
+        Region& a = regions[i];
+        check(a.x >= freed.x && a.y >= freed.y && a.x + a.w <= freed.x + freed.w && a.y + a.h <= freed.y + freed.h, "within the freed region");
+
+        for (size_t j = i + 1; j < regions.size(); j++) {
+
+            Region& b = regions[j];
+            bool apart = (
+                a.x + a.w + Core::Atlas::padding <= b.x || b.x + b.w + Core::Atlas::padding <= a.x ||
+                a.y + a.h + Core::Atlas::padding <= b.y || b.y + b.h + Core::Atlas::padding <= a.y
+            );
+
+            check(apart, "padded apart");
+        }
+    }
+}
+
+// Line geometry
+//--------------------------------------------------
+
+// Random polylines: sharp turns, near straight runs, doubling back, repeated directions
+std::vector<PolylinePoint> randomLines(size_t lines) {
+
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> coord(-1000.0f, 1000.0f), unit(0.0f, 1.0f);
+
+    PolylinePoint separator = { 0, 0, 0, 0, 0, 0, -1 };
+    std::vector<PolylinePoint> points = { separator };
+
+    for (size_t line = 0; line < lines; line++) {
+
+        size_t count = 2 + random() % 64;
+        float width = 0.5f + 8.0f * unit(random);
+
+        float x = coord(random), y = coord(random);
+
+        for (size_t i = 0; i < count; i++) {
+
+            points.push_back({ x, y, width, unit(random), unit(random), unit(random), unit(random) });
+
+            switch (random() % 4) {
+                case (0): { x = coord(random); y = coord(random); break; }
+                case (1): { x += 1.0f + 20.0f * unit(random); break; }
+                case (2): { x -= 5.0f * unit(random) + 0.5f; y += 0.001f; break; }
+                default: { x += 40.0f * unit(random) - 20.0f; y += 40.0f * unit(random) - 20.0f + 0.01f; break; }
+            }
+        }
+
+        points.push_back(separator);
+    }
+
+    return points;
+}
+
+// Vertices must match bit for bit (the same math, built without contracting to FMA)
+bool same(const Vec2& a, const Vec2& b) {
+    return !std::memcmp(&a, &b, sizeof(Vec2));
+}
+
+// A hand port of Polyline.vert, statement for statement (Polyline.metal is the same), for one
+// vertex of one instance. Nothing here compiles the shaders, so edits to them must be made here too. Instances read a window of 4 records (x, y, width, then color) from the
+// stream, as the vertex fetch does, and the projection is left out.
+struct Float2 {
+    float x, y;
+    Float2 operator+(Float2 o) const { return { x + o.x, y + o.y }; }
+    Float2 operator-(Float2 o) const { return { x - o.x, y - o.y }; }
+    Float2 operator*(float s) const { return { x * s, y * s }; }
+    Float2 operator/(float s) const { return { x / s, y / s }; }
+};
+
+Float2 operator*(float s, Float2 v) { return v * s; }
+float length(Float2 v) { return std::sqrt(v.x * v.x + v.y * v.y); }
+
+Vec2 polylineVertex(const float* stream, size_t instance, int vertexId) {
+
+    const float* iPrev = stream + (instance + 0) * 7;
+    const float* iStart = stream + (instance + 1) * 7;
+    const float* iEnd = stream + (instance + 2) * 7;
+    const float* iNext = stream + (instance + 3) * 7;
+
+    const float* iPrevColor = iPrev + 3;
+    const float* iStartColor = iStart + 3;
+    const float* iEndColor = iEnd + 3;
+    const float* iNextColor = iNext + 3;
+
+    // Not a segment, nothing to draw
+    if (iStartColor[3] < 0.0f || iEndColor[3] < 0.0f) {
+        return { 0, 0, 0, 0, 0, 0 };
+    }
+
+    float halfT = iStart[2] * 0.5f;
+
+    Float2 A = { iPrev[0], iPrev[1] }, B = { iStart[0], iStart[1] }, C = { iEnd[0], iEnd[1] }, D = { iNext[0], iNext[1] };
+
+    Float2 u = (C - B) / length(C - B);
+    Float2 h = Float2{ -u.y, u.x } * halfT;
+
+    Float2 a = B + h, b = B - h, c = C - h, d = C + h;
+
+    if (iPrevColor[3] >= 0.0f) {
+
+        Float2 pu = (B - A) / length(B - A);
+        Float2 ph = Float2{ -pu.y, pu.x } * halfT;
+
+        float cross = pu.x * u.y - pu.y * u.x;
+        float side = cross < 0.0f ? -1.0f : 1.0f;
+
+        Float2 i1 = A + side * ph;
+        Float2 i2 = B + side * h;
+
+        float t = ((i2.x - i1.x) * u.y - (i2.y - i1.y) * u.x) / cross;
+        Float2 join = std::fabs(cross) > 1e-3f ? i1 + pu * t : i2;
+
+        if (cross < 0.0f) { b = join; }
+        else { a = join; }
+    }
+
+    Float2 o1 = C, o2 = C, join = C;
+
+    if (iNextColor[3] >= 0.0f) {
+
+        Float2 nu = (D - C) / length(D - C);
+        Float2 nh = Float2{ -nu.y, nu.x } * halfT;
+
+        float cross = u.x * nu.y - u.y * nu.x;
+        float side = cross < 0.0f ? -1.0f : 1.0f;
+
+        Float2 i1 = B + side * h;
+        Float2 i2 = C + side * nh;
+
+        float t = ((i2.x - i1.x) * nu.y - (i2.y - i1.y) * nu.x) / cross;
+        join = std::fabs(cross) > 1e-3f ? i1 + u * t : i2;
+
+        if (cross < 0.0f) { c = join; }
+        else { d = join; }
+
+        o1 = C - side * h;
+        o2 = C - side * nh;
+    }
+
+    Float2 corners[9] = { a, b, c, a, c, d, o1, o2, join };
+
+    int vid = vertexId % 9;
+
+    const float* color = (vid == 0 || vid == 1 || vid == 3) ? iStartColor : iEndColor;
+
+    return { corners[vid].x, corners[vid].y, color[0], color[1], color[2], color[3] };
+}
+
+// The port of the shader (one instance per window, 9 vertices each) gives what the CPU reference does
+void polylineShaderPort() {
+
+    std::vector<PolylinePoint> points = randomLines(1024);
+
+    size_t segments = PolylineBatch::segments(points.data(), points.size());
+    std::vector<Vec2> reference(segments * PolylineVertsPer);
+
+    size_t expected = triangulatePolyline(points.data(), points.size(), reference.data());
+
+    const float* stream = &points[0].x;
+    size_t instances = points.size() - 3;
+    size_t segment = 0, differing = 0;
+    bool degenerate = true;
+
+    for (size_t instance = 0; instance < instances; instance++) {
+
+        bool isSegment = points[instance + 1].a >= 0 && points[instance + 2].a >= 0;
+
+        for (int vid = 0; vid < int(PolylineVertsPer); vid++) {
+
+            Vec2 vertex = polylineVertex(stream, instance, instance * PolylineVertsPer + vid);
+
+            if (!isSegment) { degenerate = degenerate && !vertex.x && !vertex.y && !vertex.a; }
+            else if (segment < segments) { differing += !same(reference[segment * PolylineVertsPer + vid], vertex); }
+        }
+
+        segment += isSegment;
+    }
+
+    std::printf("  %zu segments, %zu vertices differ\n", segments, differing);
+
+    check(segment * PolylineVertsPer == expected, "same segments expanded");
+    check(degenerate, "windows which aren't segments collapse");
+    check(!differing, "same vertices as the reference");
+}
+
+// Expanding in batches (vectorized) gives what the reference does
+void polylineBatch() {
+
+    std::vector<PolylinePoint> points = randomLines(4096);
+
+    size_t segments = PolylineBatch::segments(points.data(), points.size());
+    std::vector<Vec2> reference(segments * PolylineVertsPer), batched(segments * PolylineVertsPer);
+
+    size_t expected = triangulatePolyline(points.data(), points.size(), reference.data());
+    size_t written = PolylineBatch().triangulate(points.data(), points.size(), batched.data());
+
+    size_t differing = 0;
+
+    for (size_t i = 0; written == expected && i < written; i++) {
+        differing += !same(reference[i], batched[i]);
+    }
+
+    std::printf("  %zu segments, %zu lanes, %zu vertices differ\n", segments, PolylineSimd::Width, differing);
+
+    check(written == expected, "same segments expanded");
+    check(!differing, "same vertices as the reference");
+}
+
+// Running
+//--------------------------------------------------
+
+struct Test {
+    const char* name;
+    void (*run)();
+};
+
+int main(int argc, char** argv) {
+
+    std::vector<Test> tests = {
+        { "deleteWhileAnimating", deleteWhileAnimating },
+        { "deleteUnderCursor", deleteUnderCursor },
+        { "releaseInFlight", releaseInFlight },
+        { "textBoxWraps", textBoxWraps },
+        { "atlasReuse", atlasReuse },
+        { "polylineShaderPort", polylineShaderPort },
+        { "polylineBatch", polylineBatch },
+    };
+
+    const char* only = argc > 1 ? argv[1] : nullptr;
+    size_t failed = 0;
+
+    for (Test& test : tests) {
+
+        if (only && std::strcmp(only, test.name)) { continue; }
+
+        failures = 0;
+        test.run();
+
+        std::printf("%s %s\n", test.name, failures ? "failed" : "passed");
+        failed += failures ? 1 : 0;
+    }
+
+    return failed ? 1 : 0;
+}